@@ -123,6 +123,11 @@ histopTbl = {
 
 local key = constant.key
 local g = global
+local sound = constant.sound
+local hurtSounds = {}
+for i = 1, 10 do
+	hurtSounds[i] = sound["vaki/hurt"..i]
+end
 local s = _states
 local v = _vectors
 local at = attackFlag
@@ -188,8 +193,7 @@ function hurtSound(actor)
 	if(actor.totalSubframeCount == 0) then
 		local chance = g.Random(0,1)
 		if(chance < 0.5) then
-			local str = "vaki/hurt"..g.RandomInt(1,10)
-			g.PlaySound(str)
+			g.PlaySound(hurtSounds[g.RandomInt(1,10)])
 		end
 	end
 	
@@ -198,7 +202,7 @@ function hurtSound(actor)
 			(actor.currentSequence == 29 and actor.currentFrame == 5) or
 			(actor.currentSequence == 30 and actor.currentFrame == 11)
 			) then
-			global.PlaySound("bounce")
+			global.PlaySound(sound.bounce)
 		end
 	end
 end
@@ -328,7 +332,7 @@ function s5a (actor)
 		hitdef.blockStun = 14
 		hitdef.damage = 300
 		hitdef.attackFlags = at.hitsAir
-		hitdef.sound = "punchWeak"
+		hitdef.sound = sound.punchWeak
 	end
 end
 
@@ -340,7 +344,7 @@ function s5b (actor)
 		hitdef.blockStun = 17
 		hitdef.damage = 700
 		hitdef.attackFlags = at.hitsAir
-		hitdef.sound = "kickMedium"
+		hitdef.sound = sound.kickMedium
 	end
 end
 
@@ -353,11 +357,11 @@ function s5c (actor)
 		hitdef.damage = 1400
 		hitdef.shakeTime = 12
 		hitdef.attackFlags = at.hitsAir
-		hitdef.sound = "kickStrong"
+		hitdef.sound = sound.kickStrong
 	elseif(actor.currentFrame == 27 and actor.subframeCount == 0) then
 		local chance = g.Random(0,1)
 		if(chance < 0.75) then
-			g.PlaySound("vaki/076")
+			g.PlaySound(sound["vaki/076"])
 		end
 	end
 end
@@ -370,7 +374,7 @@ function s2a (actor)
 		hitdef.blockStun = 14
 		hitdef.damage = 350
 		hitdef.attackFlags = at.hitsStand
-		hitdef.sound = "punchWeak"
+		hitdef.sound = sound.punchWeak
 	elseif(actor.currentFrame == 1 and actor.subframeCount == 0) then
 		A_spawnPosRel(actor, 113)
 	end
@@ -383,7 +387,7 @@ function s2b (actor)
 		hitdef.hitStop = histopTbl.weakest
 		hitdef.blockStun = 14
 		hitdef.damage = 250
-		hitdef.sound = "slash"
+		hitdef.sound = sound.slash
 	elseif(actor.currentFrame == 3 and actor.subframeCount == 0) then
 		A_spawnPosRel(actor, 104)
 	end
@@ -400,7 +404,7 @@ function s2c (actor)
 		hitdef.damage = 1200
 		hitdef.shakeTime = 12
 		hitdef.attackFlags = at.hitsStand | at.hitsAir
-		hitdef.sound = "kickStrong"
+		hitdef.sound = sound.kickStrong
 	end
 end
 
@@ -415,7 +419,7 @@ function s4c (actor)
 		hitdef.damage = 500
 		hitdef.shakeTime = 12
 		hitdef.attackFlags = at.hitsAir
-		hitdef.sound = "punchStrong"
+		hitdef.sound = sound.punchStrong
 	elseif actor.currentFrame == 3 and actor.subframeCount == 0 then
 		A_spawnPosRel(actor, 110, 0, 8)
 	end
@@ -430,7 +434,7 @@ function s6c (actor)
 		hitdef.blockStun = 20
 		hitdef.shakeTime = 15
 		hitdef.attackFlags = at.hitsCrouch
-		hitdef.sound = "kickStrong"
+		hitdef.sound = sound.kickStrong
 	end
 end
 
@@ -444,7 +448,7 @@ function sja (actor)
 		hitdef.hitStop = histopTbl.weak
 		hitdef.blockStun = 14
 		hitdef.damage = 300
-		hitdef.sound = "punchWeak"
+		hitdef.sound = sound.punchWeak
 	end
 end
 
@@ -458,7 +462,7 @@ function sjb (actor)
 		hitdef.hitStop = histopTbl.medium
 		hitdef.blockStun = 17
 		hitdef.damage = 700
-		hitdef.sound = "kickMedium"
+		hitdef.sound = sound.kickMedium
 	end
 end
 
@@ -474,7 +478,7 @@ function sjc (actor)
 		hitdef.damage = 1000
 		hitdef.shakeTime = 12
 		hitdef.attackFlags = at.hitsCrouch
-		hitdef.sound = "punchStrong"
+		hitdef.sound = sound.punchStrong
 	elseif(actor.currentFrame == 4 and actor.subframeCount == 0) then
 		A_spawnPosRel(actor, 138,0,0,actorFlag.followParent):Attach(actor)
 		A_spawnPosRel(actor, 139,0,0,actorFlag.followParent):Attach(actor)
@@ -491,7 +495,7 @@ function s3c (actor)
 		hitdef.blockStun = 20
 		hitdef.damage = 700
 		hitdef.shakeTime = 8
-		hitdef.sound = "punchStrong"
+		hitdef.sound = sound.punchStrong
 	elseif(actor.currentFrame == 4 and actor.subframeCount == 0) then
 		A_spawnPosRel(actor, 102)
 	end
@@ -509,7 +513,7 @@ local t_sgthrow = {
 		hitdef.damage = 700
 		hitdef.shakeTime = 4
 		hitdef.attackFlags = at.wallBounce | at.hitsAir | at.disableCollision
-		hitdef.sound = "slash"
+		hitdef.sound = sound.slash
 	end,
 	[3] = function (actor)
 		if(actor:ThrowCheck(g.GetTarget(), 50, 0 ,0)) then
@@ -521,7 +525,7 @@ local t_sgthrow = {
 			g.SetPriority(1)
 			actor:GotoFrame(13)
 			
-			g.PlaySound("kickWeak")
+			g.PlaySound(sound.kickWeak)
 			
 			local enemy = actor.userData.t
 			enemy:GotoSequence(350)
@@ -537,7 +541,7 @@ local t_sgthrow = {
 	end,
 	[19] = function (actor)
 		A_spawnPosRel(actor, 64, 43, 86)
-		global.PlaySound("slash")
+		global.PlaySound(sound.slash)
 	end,
 	[20] = function (actor)
 		local enemy = actor.userData.t
@@ -586,7 +590,7 @@ local t_sathrow_pre = {
 			actor.userData.t = global.GetTarget()
 			actor:GotoSequence(272)
 			global.SetPriority(1)
-			global.PlaySound("kickWeak")
+			global.PlaySound(sound.kickWeak)
 		end
 	end
 }
@@ -644,7 +648,7 @@ local t_sathrow = {
 	[10] = function(actor)
 		global.DamageTarget(1000)
 		global.ParticlesNormalRel(20, 14, 20)
-		global.PlaySound("punchStrong")
+		global.PlaySound(sound.punchStrong)
 	end
 }
 function sathrow(actor)
@@ -664,7 +668,7 @@ local t_s623a = {
 		hitdef.damage = 700
 		hitdef.shakeTime = 4
 		hitdef.attackFlags = at.wallBounce | at.hitsAir | at.disableCollision
-		hitdef.sound = "slash"
+		hitdef.sound = sound.slash
 	end
 }
 function s623a (actor)
@@ -683,7 +687,7 @@ function s623b (actor)
 		hitdef.hitStop = histopTbl.weakest
 		hitdef.blockStun = 17
 		hitdef.damage = 200
-		hitdef.sound = "punchMedium"
+		hitdef.sound = sound.punchMedium
 	elseif(frame == 14 and actor.subframeCount == 0) then
 		local hitdef = actor.hitDef
 		hitdef:SetVectors(s.stand, v.down, v.block1)
@@ -693,7 +697,7 @@ function s623b (actor)
 		hitdef.blockStun = 14
 		hitdef.damage = 500
 		hitdef.shakeTime = 8
-		hitdef.sound = "punchStrong"
+		hitdef.sound = sound.punchStrong
 	elseif(frame == 19 and actor.subframeCount == 0) then
 		local hitdef = actor.hitDef
 		hitdef:SetVectors(s.stand, v.slam, v.block3)
@@ -702,7 +706,7 @@ function s623b (actor)
 		hitdef.hitStop = histopTbl.strong
 		hitdef.blockStun = 20
 		hitdef.damage = 500
-		hitdef.sound = "kickStrong"
+		hitdef.sound = sound.kickStrong
 		hitdef.attackFlags = at.bounce
 	end
 end
@@ -716,7 +720,7 @@ function s236c(actor)
 		hd.blockStun = 14
 		hd.hitStop = histopTbl.medium
 		hd.selfHitStop = 4
-		hd.sound = "burn"
+		hd.sound = sound.burn
 		hd.attackFlags = at.wallpushParent
 	end
 end
@@ -730,7 +734,7 @@ function s236a(actor)
 		hd.blockStun = 14
 		hd.hitStop = histopTbl.medium
 		hd.selfHitStop = 4
-		hd.sound = "burn"
+		hd.sound = sound.burn
 		hd.attackFlags = at.wallpushParent
 	end
 end
@@ -753,7 +757,7 @@ function sChargedTsuki(actor)
 		hd.hitStop = histopTbl.weak
 		hd.blockStun = 14
 		hd.damage = 230
-		hd.sound = "burn"
+		hd.sound = sound.burn
 	end
 end
 
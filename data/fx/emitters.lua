@@ -0,0 +1,74 @@
+--Particle emitters. Each one is a list of layers that spawn together.
+--Values written as {min, max} are picked at random for every particle.
+--Angles are in degrees, speeds in units per tick.
+--  type: Particle texture. count + perAmount*amount particles are spawned.
+--  scale or scaleX/scaleY, grow or growX/growY: Size and size multiplier per tick.
+--  angle, rotation: Starting angle and angle change per tick. spinFromSpeed adds speedX*spinFromSpeed to rotation.
+--  speedX, speedY: Starting velocity. squareSpeed multiplies it by its own magnitude.
+--  alignToVelocity: Faces the direction of movement and speeds up by speedBoost in that direction.
+--  drag: Acceleration as a factor of velocity, per axis. dragDown makes the vertical one always point down.
+--  gravity: Added to the vertical acceleration.
+--  color: {r, g, b, a}, 0-255. fade multiplies it every tick, fadeWithGrow uses the grow factor instead.
+--  lifetime: Ticks until it's removed. bounce: Bounces off the floor.
+emitters = {
+	normalHit = {
+		{ --Flash
+			type = 0, count = 1,
+			angle = {0, 360},
+			scaleX = 80, scaleY = 40,
+			growX = 1.025, growY = 0.70,
+			color = {255, 64, 64, 128},
+			lifetime = 12,
+		},
+		{ --Sparks
+			type = 0, count = -1, perAmount = 1,
+			rotation = {-17.19, 17.19},
+			scale = 14,
+			grow = {0.70, 0.90},
+			speedX = {-12, 12}, speedY = {-12, 12},
+			drag = {-0.04, -0.04},
+			gravity = -0.1,
+			color = {255, 128, 128, 0},
+			lifetime = 20,
+		},
+	},
+	counterHit = {
+		{ --Flash
+			type = 0, count = 1,
+			scale = 120,
+			grow = 0.85,
+			color = {64, 128, 255, 255},
+			fade = 0.80,
+			lifetime = 20,
+		},
+		{ --Glass shards
+			type = 1, perAmount = 5,
+			rotation = {-17.19, 17.19}, spinFromSpeed = 1.72,
+			scale = {5.5, 15.5},
+			grow = {0.89, 0.99}, fadeWithGrow = true,
+			speedX = {-2.5, 2.5}, speedY = {-5, 5}, squareSpeed = true,
+			drag = {0.01, 0.01}, dragDown = true,
+			gravity = -0.4,
+			color = {{0, 255}, {56, 255}, {128, 255}, 0},
+			lifetime = 120,
+			bounce = true,
+		},
+	},
+	slash = {
+		{
+			type = 0, count = 1,
+			scale = 1.5,
+			grow = 0.80,
+			lifetime = 10,
+		},
+		{
+			type = 0, count = -1, perAmount = 1,
+			scaleX = 80, scaleY = 6.8,
+			grow = {0.91, 0.95},
+			speedX = {-15, 15}, speedY = {-15, 15},
+			alignToVelocity = true, speedBoost = 1,
+			drag = {-0.02, -0.02},
+			lifetime = 40,
+		},
+	},
+}
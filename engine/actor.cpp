@@ -1,22 +1,20 @@
 #include "actor.h"
+#include "chara.h"
 #include <hitbox_renderer.h>
 #include <glm/ext/matrix_transform.hpp>
 
 Actor::Actor(std::vector<Sequence> &sequences, sol::state &lua, std::vector<Actor> &actorList) :
 lua(lua),
 sequences(&sequences),
+id(nextId++),
 actorList(actorList)
 {
-	//userData = lua.create_table();
-}
-
-Actor::~Actor()
-{
-	//userData = nullptr;
 }
 
 void Actor::GotoSequence(int seq)
 {
+	if(isCharacter)
+		return static_cast<Character*>(this)->GotoSequence(seq);
 	if (seq < 0)
 		seq = 0;
 
@@ -80,17 +78,23 @@ bool Actor::GotoFrame(int frame)
 
 void Actor::SetPos(FixedPoint x, FixedPoint y)
 {
+	if(isCharacter)
+		return static_cast<Character*>(this)->SetPos(x, y);
 	root.x = x;
 	root.y = y;
 }
 
 void Actor::Translate(Point2d<FixedPoint> amount)
 {
+	if(isCharacter)
+		return static_cast<Character*>(this)->Translate(amount);
 	root += amount;
 }
 
 void Actor::Translate(FixedPoint x, FixedPoint y)
 {
+	if(isCharacter)
+		return static_cast<Character*>(this)->Translate(x, y);
 	root.x += x;
 	root.y += y;
 }
@@ -104,6 +108,7 @@ void Actor::SetSide(int _side)
 }
 
 int Actor::GetSide(){return side;}
+Point2d<FixedPoint> Actor::GetPos(){return root;}
 
 int Actor::GetSpriteIndex()
 {
@@ -134,7 +139,7 @@ RenderOptions Actor::GetRenderOptions()
 	};
 }
 
-void Actor::SendHitboxData(HitboxRenderer &hr)
+void Actor::SendHitboxData(HitboxList &boxes)
 {
 	static std::vector<float> vertices;
 	auto col = framePointer->colbox;
@@ -142,7 +147,7 @@ void Actor::SendHitboxData(HitboxRenderer &hr)
 		col = col.FlipHorizontal();
 	col = col.Translate(root);
 	vertices = {col.bottomLeft.x, col.bottomLeft.y, col.topRight.x, col.topRight.y};
-	hr.GenerateHitboxVertices(vertices, HitboxRenderer::gray);
+	boxes.Add(vertices, HitboxRenderer::gray);
 
 	Frame::boxes_t *selector[] = {&framePointer->greenboxes, &framePointer->redboxes};
 	for(int i = 0; i < 2; ++i)
@@ -159,7 +164,7 @@ void Actor::SendHitboxData(HitboxRenderer &hr)
 			vertices[bi*4 + 2] = box.topRight.x;
 			vertices[bi*4 + 3] = box.topRight.y;
 		}
-		hr.GenerateHitboxVertices(vertices, i+1);
+		boxes.Add(vertices, i+1);
 	}
 }
 
@@ -223,6 +228,8 @@ int Actor::AdvanceFrame()
 
 bool Actor::Update()
 {
+	if(isCharacter)
+		return static_cast<Character*>(this)->Update();
 	pastRoot = root;
 	if(attachPoint)
 	{
@@ -318,6 +325,8 @@ Actor& Actor::SpawnChild(int sequence)
 
 int Actor::ResolveHit(int keypress, Actor *hitter, bool AlwaysBlock)
 {
+	if(isCharacter)
+		return static_cast<Character*>(this)->ResolveHit(keypress, hitter, AlwaysBlock);
 	//TODO: call hit lua func
 	return none;
 }
@@ -355,12 +364,17 @@ int Actor::SetVectorFromTable(const sol::table &table, int side)
 	vel.y.value = vt.ySpeed*speedMultiplier;
 	accel.x.value = vt.xAccel*speedMultiplier*side;
 	accel.y.value = vt.yAccel*speedMultiplier;
-	return lua.get()["_seqTable"][vt.sequenceName].get_or(-1);
+	return vt.sequence;
 }
 
 
 void Actor::DeclareActorLua(sol::state &lua)
 {
+	lua.new_usertype<UserData>("UserData",
+		sol::meta_function::index, &UserData::Get,
+		sol::meta_function::new_index, &UserData::Set
+	);
+
 	lua.new_usertype<HitDef>("HitDef",
 		"attackFlags", &HitDef::attackFlags, 
 		"damage", &HitDef::damage, 
@@ -374,7 +388,18 @@ void Actor::DeclareActorLua(sol::state &lua)
 		"untech", &HitDef::untech, 
 		"blockStun", &HitDef::blockstun,
 		"priority", &HitDef::priority, 
-		"sound", &HitDef::hitSound, 
+		"sound", sol::property(
+			[](HitDef &hitDef){return hitDef.hitSound == intern::none ? std::string() : intern::String(hitDef.hitSound);},
+			[](HitDef &hitDef, sol::object sound){ //A handle from constant.sound or an alias.
+				if(sound.is<int>())
+					hitDef.hitSound = sound.as<int>();
+				else
+				{
+					auto alias = sound.as<std::string>();
+					hitDef.hitSound = alias.empty() ? intern::none : intern::Get(alias);
+				}
+			}
+		),
 		"hitFx", &HitDef::hitFx,
 		"SetVectors", &HitDef::SetVectors,
 		"shakeTime", &HitDef::shakeTime
@@ -459,24 +484,39 @@ void Actor::DeclareActorLua(sol::state &lua)
 
 void HitDef::SetVectors(int state, sol::table onHitTbl, sol::table onBlockTbl)
 {
+	if(state < 0 || state >= stateN)
+	{
+		std::cerr << "SetVectors: Invalid state " << state << "\n";
+		return;
+	}
 	sol::table *luaTables[2] = {&onHitTbl, &onBlockTbl};
 	for(int i = 0; i < 2; i++)
 	{
 		Vector &vt = vectorTables[state][i];
 		vt = getVectorTableFromTable(*luaTables[i]);
 	}
+	vectorMask |= 1 << state;
+}
+
+bool HitDef::HasVectors(int state) const
+{
+	return state >= 0 && state < stateN && vectorMask & (1 << state);
 }
 
 HitDef::Vector HitDef::getVectorTableFromTable(const sol::table &t)
 {
+	sol::state_view lua(t.lua_state());
 	Vector vt;
 	vt.maxPushBackTime = t["maxTime"].get_or(0x7FFFFFFF);
 	vt.xSpeed = t["xSpeed"].get_or(0);
 	vt.ySpeed = t["ySpeed"].get_or(0);
 	vt.xAccel = t["xAccel"].get_or(0);
 	vt.yAccel = t["yAccel"].get_or(0);
-	vt.sequenceName = t["ani"].get_or(std::string());
-	vt.bounceTable = t["onBounce"].get_or(std::string());
+
+	std::string sequenceName = t["ani"].get_or(std::string());
+	vt.sequence = lua["_seqTable"][sequenceName].get_or(-1);
+	std::string bounceTable = t["onBounce"].get_or(std::string());
+	vt.bounceTable = bounceTable.empty() ? intern::none : intern::Get(bounceTable);
 	return vt;
 }
 
@@ -485,3 +525,93 @@ void HitDef::Clear()
 	*this = {};
 }
 
+
+
+sol::object UserData::Get(const std::string &key, sol::this_state L) const
+{
+	int id = intern::Find(key);
+	if(id != intern::none)
+	{
+		for(const auto &slot : slots)
+		{
+			if(slot.key != id)
+				continue;
+			switch(slot.type)
+			{
+			case sol::type::boolean:
+				return sol::make_object(L, slot.boolean);
+			case sol::type::number:
+				if(slot.isInteger)
+					return sol::make_object(L, slot.integer);
+				return sol::make_object(L, slot.number);
+			case sol::type::string:
+				return sol::make_object(L, intern::String(slot.string));
+			case sol::type::userdata:
+				return sol::make_object(L, slot.character);
+			default:
+				break;
+			}
+		}
+	}
+	return sol::make_object(L, sol::lua_nil);
+}
+
+void UserData::Set(const std::string &key, sol::stack_object value)
+{
+	int id = intern::Get(key);
+	Slot *target = nullptr;
+	for(auto &slot : slots)
+	{
+		if(slot.key == id)
+		{
+			target = &slot;
+			break;
+		}
+		else if(!target && slot.key == intern::none)
+			target = &slot;
+	}
+
+	auto type = value.get_type();
+	if(type == sol::type::lua_nil || type == sol::type::none)
+	{
+		if(target && target->key == id)
+			*target = {};
+		return;
+	}
+	if(!target)
+	{
+		std::cerr << "userData: No free slots for " << key << "\n";
+		return;
+	}
+
+	Slot slot;
+	slot.key = id;
+	slot.type = type;
+	switch(type)
+	{
+	case sol::type::boolean:
+		slot.boolean = value.as<bool>();
+		break;
+	case sol::type::number:
+		slot.isInteger = lua_isinteger(value.lua_state(), value.stack_index());
+		if(slot.isInteger)
+			slot.integer = value.as<lua_Integer>();
+		else
+			slot.number = value.as<lua_Number>();
+		break;
+	case sol::type::string:
+		slot.string = intern::Get(value.as<std::string>());
+		break;
+	case sol::type::userdata:
+		if(value.is<Actor*>() && value.as<Actor*>()->isCharacter)
+		{
+			slot.character = value.as<Actor*>();
+			break;
+		}
+		[[fallthrough]];
+	default:
+		std::cerr << "userData: " << key << " must be a boolean, number, string or character.\n";
+		return;
+	}
+	*target = slot;
+}
\ No newline at end of file
@@ -2,9 +2,11 @@
 #define ACTOR_H_GUARD
 
 #include "framedata.h"
+#include "string_intern.h"
 #include <geometry.h>
 #include <fixed_point.h>
-#include <unordered_map>
+#include <array>
+#include <type_traits>
 #include <sol/sol.hpp>
 #include <glm/mat4x4.hpp>
 #include <hitbox_renderer.h>
@@ -18,11 +20,13 @@ struct HitDef
 		int maxPushBackTime;
 		int xSpeed, ySpeed;
 		int xAccel, yAccel;
-		std::string sequenceName;
-		std::string bounceTable;
+		int sequence; //Resolved through _seqTable when the vector is read. -1 if there's none.
+		int bounceTable; //Interned name of the _vectors entry used on bounce.
 	};
-	//key is type (air, cro, sta), array value is vector subtable (hit and block)
-	std::unordered_map<int, std::array<Vector, 2>> vectorTables;
+	static constexpr int stateN = 4;
+	//Indexed by state (stand, crouch, air, otg), array value is vector subtable (hit and block)
+	std::array<std::array<Vector, 2>, stateN> vectorTables;
+	uint32_t vectorMask = 0; //Bit n is set if there are vectors for state n.
 	int attackFlags = 0;
 	int damage = 0;
 	int guardDamage = 0;
@@ -37,10 +41,11 @@ struct HitDef
 	int priority = 0;
 	int hitFx = 0;
 	int shakeTime;
-	std::string hitSound;
+	int hitSound = intern::none;
 
 	void Clear();
 	void SetVectors(int state, sol::table onHit, sol::table onBlock);
+	bool HasVectors(int state) const;
 
 	enum flag{
 		canBounce = 0x1,
@@ -56,6 +61,33 @@ struct HitDef
 	static Vector getVectorTableFromTable(const sol::table &table);
 };
 
+class Actor;
+
+//Fixed-slot key/value store for script data. Keys are interned strings.
+//It only holds nil, booleans, numbers, strings and characters so it can be copied around with the actor.
+//Characters stay at the same address for the whole match, save states included. Other actors move, so they can't be stored.
+struct UserData
+{
+	static constexpr int slotsN = 8;
+	struct Slot
+	{
+		int key = intern::none;
+		sol::type type = sol::type::lua_nil;
+		bool isInteger;
+		union{
+			bool boolean;
+			lua_Integer integer;
+			lua_Number number;
+			int string;
+			Actor *character; //For sol::type::userdata.
+		};
+	};
+	Slot slots[slotsN];
+
+	sol::object Get(const std::string &key, sol::this_state L) const;
+	void Set(const std::string &key, sol::stack_object value);
+};
+
 struct RenderOptions
 {
 	enum
@@ -71,13 +103,17 @@ struct RenderOptions
 class Actor{
 	friend class Character;
 	friend class Player;
+	friend struct UserData;
 	std::vector<Sequence> *sequences;
+	static inline uint32_t nextId = 0; //Actors are only made by the simulation thread, or before it starts.
+	uint32_t id; //Kept by copies, so it follows the actor when its vector grows.
 
 protected:
 	std::reference_wrapper<std::vector<Actor>> actorList;
 	std::reference_wrapper<sol::state> lua;
 
 	Actor* attachPoint = nullptr;
+	bool isCharacter = false; //Character methods are dispatched by hand so actors stay trivially copyable.
 	HitDef attack;
 	//sol::state &lua;
 
@@ -115,24 +151,25 @@ protected:
 	//comboType is set to hurt/blocked by the target. Resets when sequence changes. Used for cancelling purposes.
 	int comboType = none; 
 	uint32_t flags = 0;
-	std::unordered_map<std::string, sol::object> userData;
+	UserData userData;
 	glm::mat4 customTransform = glm::mat4(1);
 
 public:
 	Actor(std::vector<Sequence> &sequences, sol::state &lua, std::vector<Actor> &actorList);
-	~Actor();
 
-	virtual bool Update();
+	bool Update();
 
 	//Returns 1 if the frame advanced, 0 if it didn't and -1 if there's no next frame available.
 	int AdvanceFrame();
-	virtual void GotoSequence(int seq);
+	void GotoSequence(int seq);
 	bool GotoFrame(int frame);
-	virtual void SetPos(FixedPoint x, FixedPoint y);
-	virtual void Translate(Point2d<FixedPoint> amount);
-	virtual void Translate(FixedPoint x, FixedPoint y);
+	void SetPos(FixedPoint x, FixedPoint y);
+	void Translate(Point2d<FixedPoint> amount);
+	void Translate(FixedPoint x, FixedPoint y);
 	void SetSide(int side);
 	int GetSide();
+	Point2d<FixedPoint> GetPos();
+	uint32_t GetId() const {return id;}
 
 	Actor& SpawnChild(int sequence = 0);
 
@@ -145,12 +182,12 @@ public:
 	static std::pair<bool, Point2d<FixedPoint>> HitCollision(const Actor& hurt, const Actor& hit);
 	static void DeclareActorLua(sol::state &lua);
 
-	void SendHitboxData(HitboxRenderer &hr);
+	void SendHitboxData(HitboxList &boxes);
 
 protected:
 	void SeqFun();
 	void SetHitDef(sol::table onHit, sol::table onBlock);
-	virtual int ResolveHit(int keypress, Actor *hitter, bool AlwaysBlock = false);
+	int ResolveHit(int keypress, Actor *hitter, bool AlwaysBlock = false);
 
 	bool ThrowCheck(Actor& enemy, int frontRange, int upRange, int downRange);
 	int SetVectorFromTable(const sol::table &table, int side);
@@ -162,4 +199,7 @@ protected:
 	};
 };
 
+//Savestates copy every actor, every frame.
+static_assert(std::is_trivially_copyable_v<Actor>);
+
 #endif /* ACTOR_H_GUARD */
@@ -1,19 +1,67 @@
 #include "audio.h"
+#include "string_intern.h"
+#include <script_file.h>
+#include <vfs.h>
+#include <trace.h>
 #include <sol/sol.hpp>
 #include <iostream>
 
 SoLoud::Soloud* soloud = nullptr;
+Music* music = nullptr;
+
+Music::~Music()
+{
+	Stop();
+}
+
+void Music::Play(const std::string &file, double loopPoint)
+{
+	Stop();
+	if(file != this->file || !stream)
+	{
+		TRACE_ZONE_DETAIL("Music", file);
+		stream.reset();
+		this->file = file;
+		data = vfs::Open(file);
+		if(!data)
+		{
+			std::cerr << "Can't open music file " << file << "\n";
+			return;
+		}
+		//Only the headers are read here. The mixer thread decodes ahead of the voice as it plays.
+		stream = std::make_unique<SoLoud::WavStream>();
+		if(stream->loadMem((const unsigned char*)data.Data(), data.Size(), false, false) != SoLoud::SO_NO_ERROR)
+		{
+			std::cerr << "Can't decode music file " << file << "\n";
+			stream.reset();
+			return;
+		}
+		stream->setLooping(true);
+	}
+	stream->setLoopPoint(loopPoint);
+	voice = soloud->play(*stream);
+	soloud->setProtectVoice(voice, true);
+}
+
+void Music::Stop()
+{
+	if(voice)
+		soloud->stop(voice);
+	voice = 0;
+}
 
 SoundEffects::SoundEffects(int &gameTime):
+queue(*soloud),
 gameTime(gameTime)
 {}
 
 void SoundEffects::LoadFromDef(const std::filesystem::path &file)
 {
+	TRACE_ZONE("SoundEffects::LoadFromDef");
 	auto folder = file.parent_path();
 	sol::state lua;
 
-	auto result = lua.script_file(file.string());
+	auto result = ScriptFile(lua, file);
 	if(!result.valid()){
 		sol::error err = result;
 		std::cerr << "When loading " << file <<"\n";
@@ -21,48 +69,51 @@ void SoundEffects::LoadFromDef(const std::filesystem::path &file)
 		throw std::runtime_error("Lua syntax error.");
 	}
 
-	auto previousPath = std::filesystem::current_path();
-	std::filesystem::current_path(folder);
 	sol::table sfxTable = lua["sfx"];
 	for(auto &entry : sfxTable)
 	{
-		//Second column has the filepath.
-		LoadSound(entry.second.as<std::string>(), entry.first.as<std::string>());
+		//Second column has the filepath, relative to the def file.
+		LoadSound((folder/entry.second.as<std::string>()).generic_string(), entry.first.as<std::string>());
 	}
-
-	std::filesystem::current_path(previousPath);
 }
 
 void SoundEffects::LoadSound(const std::string &file, const std::string &alias)
 {
-	if(aliasMap.count(alias) > 0) //Alias already exists. Maybe throw.
+	size_t handle = intern::Get(alias);
+	if(handle < sounds.size() && sounds[handle]) //Alias already exists. Maybe throw.
 		return;
+	if(handle >= sounds.size())
+		sounds.resize(handle+1, nullptr);
+	aliases.push_back(handle);
 
 	auto search = loadedResources.find(file);
 	if(search != loadedResources.end()) //Find whether resource is already loaded.
 	{
-		aliasMap.insert({alias, search->second});
+		sounds[handle] = search->second;
 		return;
 	}
 	else
 	{
+		TRACE_ZONE_DETAIL("Sound file", file);
 		auto wav = wavs.emplace_back(new SoLoud::Wav).get();
-		wav->load(file.c_str());
+		//Wav decodes everything right away, so the data doesn't have to outlive the call.
+		auto data = vfs::Open(file);
+		if(data)
+			wav->loadMem((unsigned char*)data.Data(), data.Size(), false, false);
+		else
+			std::cerr << "Can't open sound file " << file << "\n";
 		loadedResources.insert({file, wav});
-		aliasMap.insert({alias, wav});
+		sounds[handle] = wav;
 	}
 }
 
-void SoundEffects::PlaySound(const std::string &alias)
+void SoundEffects::PlaySound(int handle)
 {
-	if(lastGameTime != gameTime)
-	{
-		lastGameTime = gameTime;
-		offset = 0;
-	}
+	if(handle >= 0 && (size_t)handle < sounds.size() && sounds[handle])
+		queue.Request(gameTime, sounds[handle]);
+}
 
-	auto search = aliasMap.find(alias);
-	if (search != aliasMap.end())
-		soloud->playClocked(gameTime/60.f+offset, *search->second);
-	offset+=0.005;
-}
\ No newline at end of file
+void SoundEffects::PlaySound(const std::string &alias)
+{
+	PlaySound(intern::Find(alias));
+}
@@ -4,6 +4,8 @@
 #include <soloud.h>
 #include <soloud_wav.h>
 #include <soloud_wavstream.h>
+#include "sound_queue.h"
+#include <vfs.h>
 #include <filesystem>
 #include <string>
 #include <vector>
@@ -12,25 +14,49 @@
 
 extern SoLoud::Soloud* soloud;
 
+//Background music decoded as it plays, straight from the data file.
+//Stays loaded after the match so playing the same track again doesn't load anything.
+class Music{
+private:
+	std::string file;
+	vfs::File data; //The stream reads from here, so it lives as long as the stream.
+	std::unique_ptr<SoLoud::WavStream> stream;
+	SoLoud::handle voice = 0;
+
+public:
+	~Music();
+	void Play(const std::string &file, double loopPoint);
+	void Stop();
+};
+
+extern Music* music;
+
 
 
 #undef PlaySound
+//Looks sounds up by alias and queues them in a SoundQueue for the current frame.
 class SoundEffects{
 private:
 	std::vector<std::unique_ptr<SoLoud::Wav>> wavs;
 	std::unordered_map<std::string, SoLoud::Wav*> loadedResources;
-	std::unordered_map<std::string, SoLoud::Wav*> aliasMap;
+	std::vector<SoLoud::Wav*> sounds; //Indexed by interned alias. Null for strings that aren't sounds.
+	std::vector<int> aliases; //Loaded ones.
 
 	void LoadSound(const std::string &file, const std::string &alias = {});
 
+	SoundQueue queue;
 	int &gameTime;
-	int lastGameTime;
-	float offset;
 
 public:
 	SoundEffects(int &);
 	void LoadFromDef(const std::filesystem::path &file);
+	//Handles are the interned aliases. The string version looks the alias up every time.
+	void PlaySound(int handle);
 	void PlaySound(const std::string &alias);
+	const std::vector<int> &Aliases() const { return aliases; }
+
+	void Rollback(int frame) { queue.Rollback(frame); } //See SoundQueue.
+	void Dispatch() { queue.Dispatch(gameTime); }
 };
 
 #endif // AUDIO_H_INCLUDED
@@ -5,10 +5,18 @@
 #include "window.h"
 
 #include "game_state.h"
+#include "netplay.h"
 #include "stage.h"
 #include <gfx_handler.h>
+#include <script_file.h>
+#include <trace.h>
+#include <algorithm>
+#include <chrono>
+#include <exception>
 #include <fstream>
 #include <sstream>
+#include <stdexcept>
+#include <thread>
 #include <vector>
 #include <ggponet.h>
 
@@ -16,11 +24,16 @@
 #include "audio.h"
 
 int inputDelay = 0;
+constexpr double simPeriod = 1.0/60.0; //simPacer's default.
+//Spectators this many frames behind the stream simulate catchUpFrames per step.
+constexpr int catchUpBacklog = 30;
+constexpr int catchUpFrames = 4;
 
-BattleScene::BattleScene(ENetHost *local):
+BattleScene::BattleScene(ENetHost *local, bool spectating):
 sfx(gameTicks),
 local(local),
-particles(rng),
+spectating(spectating),
+particles(rng, &workers, &emitters),
 interface{rng, particles, view, sfx},
 player(interface), player2(interface),
 hr(mainWindow->renderer)
@@ -42,9 +55,7 @@ int BattleScene::PlayLoop(bool replay, int matchType, int playerId, const std::s
 	float clearColor[] = {1,1,1,1};
 	mainWindow->renderer.SetClearColor(clearColor);
 
-	SoLoud::Wav music;
-	
-	size_t inputSize;
+	size_t inputSize = 0;
 	if(replay)
 	{
 		std::ifstream replayFile("replay", std::ios_base::binary);
@@ -81,35 +92,44 @@ int BattleScene::PlayLoop(bool replay, int matchType, int playerId, const std::s
 	if (matchType == 2)
 		p1ai = true;	
 		
+	//Before the players, so their scripts get the sound handles.
+	sfx.LoadFromDef("data/sfx/sfx.lua");
 	player.Load(1, "data/char/vaki/vaki.fdat", 0, p1ai);
 	player2.Load(-1, "data/char/vaki/vaki.fdat", 1, p2ai);
 	
-	sfx.LoadFromDef("data/sfx/sfx.lua");
+	emitters.LoadFromLua("data/fx/emitters.lua");
 	
 	GfxHandler gfx(&mainWindow->renderer);
 	gfx.LoadGfxFromDef("data/char/vaki/def.lua");
 	std::string stageLuaFile("data/stage/");
 	
 	{//TODO: music shit
+		TRACE_ZONE("BGM");
 		sol::state lua;
-		lua.script_file("data/stage/stages.lua");
+		auto run = [&lua](const char *file){
+			auto result = ScriptFile(lua, file);
+			if(!result.valid()){
+				sol::error err = result;
+				std::cerr << "When loading " << file <<"\n";
+				std::cerr << err.what() << std::endl;
+				throw std::runtime_error("Lua syntax error.");
+			}
+		};
+		run("data/stage/stages.lua");
 		sol::table selectedStage = lua["stageList"]["testStage"];
 		stageLuaFile.append(selectedStage["lua"]);
 
-		lua.script_file("data/bgm/bgm.lua");
+		run("data/bgm/bgm.lua");
 		sol::table bgmEntry = lua["bgm"][selectedStage["bgm"]];
 		std::string bgmFile = "data/bgm/";
 		bgmFile.append(bgmEntry["file"]);
 		
-		music.setLooping(true);
-		music.setLoopPoint(bgmEntry["loop"].get_or(0.0));
-		music.load(bgmFile.c_str());
-		auto h = soloud->play(music);
-		soloud->setProtectVoice(h, true);
+		music->Play(bgmFile, bgmEntry["loop"].get_or(0.0));
 	}
 
 	Stage stage(gfx, stageLuaFile);
 	gfx.LoadingDone();
+	TRACE_WRITE("startup_trace.json");
 
 	player.SetTarget(player2);
 	player2.SetTarget(player);
@@ -122,125 +142,171 @@ int BattleScene::PlayLoop(bool replay, int matchType, int playerId, const std::s
 	
 
 	auto keyHandler = std::bind(&BattleScene::KeyHandle, this, std::placeholders::_1);
-	bool drawn = false;
+	//SDL only takes events from the thread that made the window, so this one also samples input while it waits.
+	auto pollInput = [&keyHandler](){ EventLoop(keyHandler, false); };
 
-	if(local)
+	if(spectating)
+		spectatorStream = std::make_unique<SpectatorClient>(local);
+	else if(local)
 	{
 		if(!SetupGgpo(playerId, address))
 		{
 			mainWindow->wantsToClose = true;
 			std::cerr << "Error setting ggpo up";
+			music->Stop();
 			return 0;
 		}
+		//GGPO owns the game socket, so spectators connect to the next port.
+		if(playerId == 0)
+		{
+			broadcaster = std::make_unique<SpectatorServer>(local->address.port + 1, net::spectatorDelay);
+			if(!*broadcaster)
+				broadcaster.reset();
+		}
 	}
-	
+
+	//Rethrown here so errors in the simulation end the match the same way they used to.
+	//If rendering throws instead, the simulation is stopped and joined on the way out.
+	std::exception_ptr simError;
+	std::jthread simThread([&](std::stop_token stop){
+		try{
+			SimulationLoop(stop, replay, inputSize, playerId, gfx);
+		}
+		catch(...){
+			simError = std::current_exception();
+			mainWindow->wantsToClose = true;
+		}
+	});
+
+	SnapshotHistory previous, current;
 	while(!mainWindow->wantsToClose)
 	{
-		EventLoop(keyHandler, pause);
-		if(pause){
-			if(!step)
-				continue;
-			else
-				step = false;
+		{
+			FrameTimer::Scope scope(renderTimer, FrameTimer::events);
+			EventLoop(keyHandler, false);
 		}
-		
-		if(replay)
+
+		int shownSlice = snapshots.Front().particleSlice; //Can't be read after Update hands the snapshot back.
+		if(snapshots.Update())
 		{
-			if(gameTicks >= inputSize)
-			{
-				mainWindow->wantsToClose = true;
-				break;
-			}
-			AdvanceFrame();
+			gfx.ReleaseParticleSlice(shownSlice);
+			std::swap(previous, current);
+			current.Remember(snapshots.Front());
 		}
-		else if(ggpo)
+		const RenderSnapshot &snapshot = snapshots.Front();
+		if(snapshot.gameTicks < 0) //Nothing simulated yet.
 		{
-			ggpo_idle(ggpo, 0);
-			unsigned int ginputs[2];
-			//Grab p1 controller only. 
-			auto result = ggpo_add_local_input(ggpo, playerHandle[playerId], &keySend[0], sizeof(unsigned int));
-			if (GGPO_SUCCEEDED(result))
-			{
-				result = ggpo_synchronize_input(ggpo, (void *)ginputs, sizeof(unsigned int) * 2, nullptr);
-				inputs[0].buffer.push_back(ginputs[0]);
-				inputs[1].buffer.push_back(ginputs[1]);
-				AdvanceFrame();
-				drawn = false;
-			}
-			if(drawn)
-				continue;
-			else
-				drawn = true;
+			FrameTimer::Scope scope(renderTimer, FrameTimer::sleep);
+			mainWindow->SleepUntilNextFrame(pollInput);
+			continue;
 		}
-		else
+
+		//With a faster display, frames between simulation steps blend the last two snapshots.
+		//This shows the simulation one step late, so it's only done when it makes a difference.
+		float alpha = 1;
+		if(previous.Precedes(snapshot) && mainWindow->GetSpf() < simPeriod*0.8)
 		{
-			inputs[0].buffer.push_back(keySend[0]);
-			inputs[1].buffer.push_back(keySend[1]);
-			AdvanceFrame();
+			std::chrono::duration<double> sincePublish = RenderSnapshot::Clock::now() - snapshot.published;
+			alpha = std::clamp(sincePublish.count()/simPeriod, 0.0, 1.0);
 		}
+		glm::mat4 viewMatrix = snapshot.viewMatrix;
+		centerScale center = snapshot.center;
+		if(alpha < 1)
+		{
+			viewMatrix = previous.viewMatrix*(1-alpha) + snapshot.viewMatrix*alpha;
+			center.x = previous.center.x + (center.x - previous.center.x)*alpha;
+			center.y = previous.center.y + (center.y - previous.center.y)*alpha;
+			center.scale = previous.center.scale + (center.scale - previous.center.scale)*alpha;
+		}
+		auto spriteTransform = [&](const RenderSnapshot::Sprite &sprite)
+		{
+			if(alpha < 1)
+			{
+				auto it = previous.positions.find(sprite.id);
+				if(it != previous.positions.end())
+					return glm::translate(glm::mat4(1.f), glm::vec3((it->second - sprite.pos)*(1-alpha), 0))*sprite.transform;
+			}
+			return sprite.transform;
+		};
 		
 		//Start rendering
+		FrameTimer::Scope recordScope(renderTimer, FrameTimer::record);
 		mainWindow->renderer.Acquire(); //Prepare for rendering. Must be here because the window may get resized and it requires a call to end drawing.
 		
-		drawList.Init(player, player2);
-		
-		if(gfx.Begin())
+		if(gfx.Begin(worldLayer))
 		{
-			//Draw stage
-			auto center = view.GetCameraCenterScale();
-			stage.Draw(projection*viewMatrix, center);
-
-			int p1Pos = players[1]->FillDrawList(drawList);
-			int p2Pos = players[0]->FillDrawList(drawList);
-
-			auto draw = [this,&gfx](Actor *actor, glm::mat4 &viewMatrix)
+			auto drawWorld = [&]()
 			{
-				gfx.SetMatrix(projection*viewMatrix*actor->GetSpriteTransform());
-				auto options = actor->GetRenderOptions();
-				gfx.SetBlendingMode(options.blendingMode);
-				
-				if(options.paletteIndex == 0)
-					gfx.SetPaletteSlot(0);
-				else
-					gfx.SetPaletteSlot(3);
-				gfx.Draw(actor->GetSpriteIndex(), 0);
+				//Draw stage
+				stage.Draw(projection*viewMatrix, center);
+
+				auto draw = [&](const RenderSnapshot::Sprite &sprite, glm::mat4 &viewMatrix)
+				{
+					gfx.SetMatrix(projection*viewMatrix*spriteTransform(sprite));
+					auto &options = sprite.options;
+					gfx.SetBlendingMode(options.blendingMode);
+					
+					if(options.paletteIndex == 0)
+						gfx.SetPaletteSlot(0);
+					else
+						gfx.SetPaletteSlot(3);
+					gfx.Draw(sprite.spriteIndex, 0);
+				};
+
+				auto invertedView = glm::translate(glm::scale(viewMatrix, glm::vec3(1,-1,1)), glm::vec3(0,-64,0));
+
+				//Draw player reflection?
+
+				gfx.SetMulColor(1, 1, 1, 0.2);
+				draw(snapshot.sprites[snapshot.reflections[0]], invertedView);
+				draw(snapshot.sprites[snapshot.reflections[1]], invertedView);
+				gfx.SetMulColorRaw(1,1,1,1);
+			
+				//Draw all actors
+				for(auto &sprite : snapshot.sprites)
+				{
+					draw(sprite, viewMatrix);
+				}
+				gfx.Flush();
 			};
 
-			auto invertedView = glm::translate(glm::scale(viewMatrix, glm::vec3(1,-1,1)), glm::vec3(0,-64,0));
-
-			//Draw player reflection?
-
-			gfx.SetMulColor(1, 1, 1, 0.2);
-			draw(drawList.v[p1Pos], invertedView);
-			draw(drawList.v[p2Pos], invertedView);
-			gfx.SetMulColorRaw(1,1,1,1);
-		
-			//Draw all actors
-			for(auto actor : drawList.v)
-			{
-				draw(actor,viewMatrix);
-			}
-
-
-			gfx.SetMatrix(projection*viewMatrix);
-			gfx.DrawParticles(particles);
-		}
-
-		//Draw boxes
-		if(drawBoxes)
-		{
-			hr.LoadHitboxVertices();
-			hr.Draw(projection*viewMatrix);
+			//Each layer goes into its own secondary command buffer. They're executed in order.
+			recorders.ParallelFor(layerCount, [&](size_t layer){
+				switch(layer)
+				{
+				case worldLayer:
+					drawWorld();
+					break;
+				case particleLayer:
+					gfx.DrawParticles(snapshot.particleSlice, snapshot.particleDraws, projection*viewMatrix, particleLayer);
+					break;
+				case boxLayer:
+					if(drawBoxes)
+					{
+						hr.GenerateHitboxVertices(snapshot.boxes);
+						hr.LoadHitboxVertices();
+						hr.Draw(projection*viewMatrix, boxLayer);
+					}
+					break;
+				case hudLayer:
+					//Guard bar
+					hud.ResizeBarId(0, snapshot.health[0]);
+					hud.ResizeBarId(1, snapshot.health[1]);
+					//Health bars
+					hud.ResizeBarId(2, snapshot.health[0]);
+					hud.ResizeBarId(3, snapshot.health[1]);
+					if(overlay == timingsOverlay)
+					{
+						simTimer.DrawOverlay(hud, 8);
+						renderTimer.DrawOverlay(hud, 118);
+					}
+					else if(overlay == netplayOverlay)
+						netStats.DrawOverlay(hud, 8);
+					hud.Draw(hudLayer);
+					break;
+				}
+			});
 		}
-				
-		//Draw HUD
-		//Guard bar
-		hud.ResizeBarId(0, player.GetHealthRatio());
-		hud.ResizeBarId(1, player2.GetHealthRatio());
-		//Health bars
-		hud.ResizeBarId(2, player.GetHealthRatio());
-		hud.ResizeBarId(3, player2.GetHealthRatio());
-		hud.Draw();
 
  		//TODO: Goes in HUD. Draw fps bar
 /* 		timerString.seekp(0);
@@ -252,12 +318,36 @@ int BattleScene::PlayLoop(bool replay, int matchType, int playerId, const std::s
 		vaoTexOnly.UpdateBuffer(textId, textVertData.data());
 		vaoTexOnly.Draw(textId); */
 
+		recordScope.End();
+
 		//End drawing.
-		mainWindow->SwapBuffers();
-		mainWindow->SleepUntilNextFrame();
+		{
+			FrameTimer::Scope scope(renderTimer, FrameTimer::submit);
+			mainWindow->SwapBuffers();
+		}
+		{
+			FrameTimer::Scope scope(renderTimer, FrameTimer::sleep);
+			mainWindow->SleepUntilNextFrame(pollInput);
+		}
+		renderTimer.NextFrame();
+	}
+
+	simThread.join();
+	music->Stop();
+	if(simError)
+		std::rethrow_exception(simError);
+
+	if(broadcaster) //Lets spectators see the end of the match.
+		broadcaster->Finish(inputs, gameTicks - GGPO_MAX_PREDICTION_FRAMES);
+
+	if(ggpo)
+	{
+		netStats.PrintSummary();
+		if(netStats.WriteCsv("netplay_stats.csv"))
+			std::cout << "Wrote the netplay stats of the match to netplay_stats.csv\n";
 	}
 
-	if(!replay)
+	if(!replay && !spectating)
 	{
 		assert(inputs[0].buffer.size() == inputs[1].buffer.size() && inputs[0].buffer.size() == gameTicks);
 		size_t inputSize = inputs[0].buffer.size();
@@ -270,6 +360,145 @@ int BattleScene::PlayLoop(bool replay, int matchType, int playerId, const std::s
 	return GS_WIN;
 }
 
+void BattleScene::SimulationLoop(std::stop_token stop, bool replay, size_t inputSize, int playerId, GfxHandler &gfx)
+{
+	TRACE_THREAD("Simulation");
+	bool streamEnded = false;
+	inputLatch.Start();
+	while(!mainWindow->wantsToClose && !stop.stop_requested())
+	{
+		unsigned int latched[2];
+		{
+			FrameTimer::Scope scope(simTimer, FrameTimer::events);
+			RunCommands();
+			inputLatch.Latch(latched); //Right after the pacer's deadline.
+		}
+
+		if(pause){
+			if(!step)
+			{
+				simPacer.Wait();
+				continue;
+			}
+			else
+				step = false;
+		}
+
+		bool advanced = false;
+		if(replay)
+		{
+			if(gameTicks >= inputSize)
+			{
+				mainWindow->wantsToClose = true;
+				break;
+			}
+			AdvanceFrame();
+			advanced = true;
+		}
+		else if(spectatorStream)
+		{
+			if(!streamEnded && !spectatorStream->Receive(inputs))
+				streamEnded = true;
+			int backlog = (int)std::min(inputs[0].buffer.size(), inputs[1].buffer.size()) - gameTicks;
+			if(backlog <= 0 && streamEnded)
+			{
+				mainWindow->wantsToClose = true;
+				break;
+			}
+			//Catches up faster when it falls behind the stream.
+			int frames = std::min(backlog, backlog > catchUpBacklog ? catchUpFrames : 1);
+			for(int i = 0; i < frames; ++i)
+				AdvanceFrame();
+			advanced = frames > 0;
+		}
+		else if(ggpo)
+		{
+			{
+				FrameTimer::Scope scope(simTimer, FrameTimer::ggpoIdle);
+				ggpo_idle(ggpo, 0);
+			}
+			unsigned int ginputs[2];
+			FrameTimer::Scope syncScope(simTimer, FrameTimer::ggpoSync);
+			//Grab p1 controller only. 
+			auto result = ggpo_add_local_input(ggpo, playerHandle[playerId], &latched[0], sizeof(unsigned int));
+			if (GGPO_SUCCEEDED(result))
+			{
+				result = ggpo_synchronize_input(ggpo, (void *)ginputs, sizeof(unsigned int) * 2, nullptr);
+				syncScope.End();
+				inputs[0].buffer.push_back(ginputs[0]);
+				inputs[1].buffer.push_back(ginputs[1]);
+				netStats.StartSimulating();
+				AdvanceFrame();
+				netStats.StopSimulating();
+				advanced = true;
+			}
+			syncScope.End();
+			GGPONetworkStats network;
+			if(GGPO_SUCCEEDED(ggpo_get_network_stats(ggpo, playerHandle[1 - playerId], &network)))
+				netStats.EndStep(gameTicks, network);
+			//Frames older than the prediction window can't be rolled back anymore.
+			if(broadcaster)
+				broadcaster->Update(inputs, gameTicks - GGPO_MAX_PREDICTION_FRAMES);
+		}
+		else
+		{
+			inputs[0].buffer.push_back(latched[0]);
+			inputs[1].buffer.push_back(latched[1]);
+			AdvanceFrame();
+			advanced = true;
+		}
+
+		sfx.Dispatch();
+		if(advanced)
+			PublishSnapshot(gfx);
+
+		{
+			FrameTimer::Scope scope(simTimer, FrameTimer::sleep);
+			simPacer.Wait();
+		}
+		simTimer.NextFrame();
+	}
+}
+
+void BattleScene::PublishSnapshot(GfxHandler &gfx)
+{
+	FrameTimer::Scope scope(simTimer, FrameTimer::publish);
+	RenderSnapshot &snapshot = snapshots.Back();
+	snapshot.gameTicks = gameTicks;
+
+	drawList.Init(player, player2);
+	snapshot.reflections[0] = players[1]->FillDrawList(drawList);
+	snapshot.reflections[1] = players[0]->FillDrawList(drawList);
+	snapshot.sprites.clear();
+	for(auto actor : drawList.v)
+	{
+		auto pos = actor->GetPos();
+		snapshot.sprites.push_back({actor->GetId(), glm::vec2(pos.x, pos.y), actor->GetSpriteTransform(),
+			actor->GetSpriteIndex(), actor->GetRenderOptions()});
+	}
+
+	snapshot.viewMatrix = viewMatrix;
+	snapshot.center = view.GetCameraCenterScale();
+
+	//A slice the render thread has seen goes back to it, and this one may still be on the GPU.
+	if(!backUnread || snapshot.particleSlice < 0)
+		snapshot.particleSlice = gfx.AcquireParticleSlice();
+	if(snapshot.particleSlice >= 0)
+		snapshot.particleDraws = particles.FillBuffer(gfx.ParticleSlice(snapshot.particleSlice), GfxHandler::maxParticles);
+	else
+		snapshot.particleDraws.clear();
+
+	snapshot.health[0] = player.GetHealthRatio();
+	snapshot.health[1] = player2.GetHealthRatio();
+	if(drawBoxes)
+		snapshot.boxes = hitboxes;
+	else
+		snapshot.boxes.Clear();
+
+	snapshot.published = RenderSnapshot::Clock::now();
+	backUnread = snapshots.Publish();
+}
+
 void BattleScene::AdvanceFrame()
 {
 	if(player.priority >= player2.priority){
@@ -280,28 +509,38 @@ void BattleScene::AdvanceFrame()
 		players[1] = &player;
 	}
 
-	Player::HitCollision(player, player2);
+	hitboxes.Clear();
+	{
+		FrameTimer::Scope scope(simTimer, FrameTimer::hitCollision);
+		Player::HitCollision(player, player2);
+	}
 
 	for(int i = 0; i < 2; ++i)
 		inputs[i].lastLoc = gameTicks;
-	player.ProcessInput(inputs[0]);
-	player2.ProcessInput(inputs[1]);
 
-	if(drawBoxes)
 	{
-		players[0]->Update(&hr);
-		players[1]->Update(&hr);
+		FrameTimer::Scope scope(simTimer, FrameTimer::input);
+		player.ProcessInput(inputs[0]);
+		player2.ProcessInput(inputs[1]);
 	}
-	else
 	{
-		players[0]->Update(nullptr);
-		players[1]->Update(nullptr);
+		FrameTimer::Scope scope(simTimer, FrameTimer::update);
+		players[0]->Update(drawBoxes ? &hitboxes : nullptr);
+		players[1]->Update(drawBoxes ? &hitboxes : nullptr);
 	}
 	
-	Player::Collision(player, player2);
-	viewMatrix = view.Calculate(player.GetXYCoords(), player2.GetXYCoords());
-
-	particles.Update();
+	{
+		FrameTimer::Scope scope(simTimer, FrameTimer::collision);
+		Player::Collision(player, player2);
+	}
+	{
+		FrameTimer::Scope scope(simTimer, FrameTimer::camera);
+		viewMatrix = view.Calculate(player.GetXYCoords(), player2.GetXYCoords());
+	}
+	{
+		FrameTimer::Scope scope(simTimer, FrameTimer::particles);
+		particles.Update();
+	}
 
 	ggpo_advance_frame(ggpo);
 
@@ -332,6 +571,7 @@ void BattleScene::LoadState(State &state)
 	player2.SetState(state.p2);
 	view = state.view;
 	gameTicks = state.gameTicks;
+	sfx.Rollback(gameTicks);
 }
 
 bool BattleScene::KeyHandle(const SDL_KeyboardEvent &e)
@@ -340,23 +580,45 @@ bool BattleScene::KeyHandle(const SDL_KeyboardEvent &e)
 		return false;
 
 	switch (e.keysym.scancode){
- 	case SDL_SCANCODE_F1: 
-	 	if(!ggpo)
-			SaveState(savedState);
+	case SDL_SCANCODE_F1:
+		if(!ggpo)
+			PostCommand([this]{SaveState(savedState);});
 		break;
 	case SDL_SCANCODE_F2:
 		if(!ggpo)
-			LoadState(savedState);
+			PostCommand([this]{LoadState(savedState);});
 		break;
 	case SDL_SCANCODE_H:
 		drawBoxes = !drawBoxes;
 		break;
+	case SDL_SCANCODE_F3:
+		overlay = (overlay + 1) % (ggpo ? overlayCount : netplayOverlay);
+		break;
+	case SDL_SCANCODE_F4:
+		if(ggpo && netStats.WriteCsv("netplay_stats.csv"))
+			std::cout << "Wrote the netplay stats so far to netplay_stats.csv\n";
+		if(renderTimer.WriteCsv("render_times.csv"))
+			std::cout << "Wrote the last " << renderTimer.Frames() << " render frame times to render_times.csv\n";
+		if(mainWindow->GetPacer().Jitter().WriteCsv("frame_jitter.csv"))
+			std::cout << "Wrote the render interval jitter histogram to frame_jitter.csv\n";
+		PostCommand([this]{
+			if(simTimer.WriteCsv("frame_times.csv"))
+				std::cout << "Wrote the last " << simTimer.Frames() << " simulation frame times to frame_times.csv\n";
+			if(simPacer.Jitter().WriteCsv("sim_jitter.csv"))
+				std::cout << "Wrote the simulation interval jitter histogram to sim_jitter.csv\n";
+			if(inputLatch.WriteCsv("input_latency.csv"))
+				std::cout << "Input latency p50: " << inputLatch.Percentile(50) << "ms p99: " << inputLatch.Percentile(99) <<
+					"ms over the last " << inputLatch.Count() << " changes. Wrote them to input_latency.csv\n";
+		});
+		break;
 	case SDL_SCANCODE_P:
-		pause = !pause;
+		PostCommand([this]{pause = !pause;});
 		break;
 	case SDL_SCANCODE_SPACE:
-		if(pause)
-			step = true;
+		PostCommand([this]{
+			if(pause)
+				step = true;
+		});
 		break;
 	default:
 		return false;
@@ -364,22 +626,43 @@ bool BattleScene::KeyHandle(const SDL_KeyboardEvent &e)
 	return true;
 }
 
+void BattleScene::PostCommand(std::function<void()> command)
+{
+	std::lock_guard lock(commandMutex);
+	commands.push_back(std::move(command));
+}
+
+void BattleScene::RunCommands()
+{
+	std::vector<std::function<void()>> pending;
+	{
+		std::lock_guard lock(commandMutex);
+		pending.swap(commands);
+	}
+	for(auto &command : pending)
+		command();
+}
+
 bool BattleScene::SetupGgpo(int playerId, const std::string &address)
 {
 	ready = false;
 	GGPOSessionCallbacks cb = { 0 };
 	cb.begin_game      = [](const char*){return true;};
 	cb.advance_frame   = [this](int)->bool{ //Rollback only advance.
+		auto start = NetStats::Clock::now();
 		unsigned int ginputs[2];
 		ggpo_synchronize_input(ggpo, (void *)ginputs, sizeof(unsigned int) * 2, nullptr);
 		inputs[0].buffer.push_back(ginputs[0]);
 		inputs[1].buffer.push_back(ginputs[1]);
 		AdvanceFrame();
+		netStats.Resimulated(NetStats::Clock::now() - start);
 		return true;
 	};
 	cb.load_game_state = [this](unsigned char *buffer, int){
+		auto start = NetStats::Clock::now();
 		State *state = (State *)buffer;
 		LoadState(*state);
+		netStats.Rollback(NetStats::Clock::now() - start);
 		return true;
 	};
 	cb.save_game_state = [this](unsigned char **buffer, int* len, int *checksum, int){
@@ -415,7 +698,7 @@ bool BattleScene::SetupGgpo(int playerId, const std::string &address)
 			break;
 		case GGPO_EVENTCODE_TIMESYNC:
 			for(int i = 0; i < info->u.timesync.frames_ahead; ++i)
-				mainWindow->SleepUntilNextFrame();
+				simPacer.Wait();
 			break;
 		}
 		return true;
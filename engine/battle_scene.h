@@ -6,8 +6,23 @@
 #include "chara.h"
 #include "camera.h"
 #include "hud.h"
+#include "frame_timer.h"
+#include "frame_pacer.h"
+#include "input_latch.h"
+#include "net_stats.h"
+#include "render_snapshot.h"
+#include "spectator.h"
 #include "xorshift.h"
 #include <particle.h>
+#include <triple_buffer.h>
+#include <worker_pool.h>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stop_token>
+#include <vector>
 
 #include <glm/mat4x4.hpp>
 #include <SDL_events.h>
@@ -16,6 +31,8 @@
 #undef interface
 
 
+class GfxHandler;
+
 struct State
 {
 	int32_t gameTicks;
@@ -30,7 +47,19 @@ struct State
 class BattleScene
 {
 private:
+	enum drawLayer{
+		worldLayer,
+		particleLayer,
+		boxLayer,
+		hudLayer,
+		layerCount
+	};
+	static_assert(layerCount <= Renderer::externalDrawThreads);
+
 	ENetHost *local;
+	WorkerPool workers;
+	WorkerPool recorders{layerCount-1}; //Records draw layers. Separate because particles use workers while recording.
+	EmitterTable emitters;
 	XorShift32 rng;
 	ParticleGroup particles;
 	Camera view{1.55};
@@ -45,7 +74,17 @@ private:
 	bool ready = true;
 	BattleInterface interface;
 	Player player, player2;
-	bool drawBoxes = false;
+	std::atomic<bool> drawBoxes = false;
+	enum overlayPage{
+		noOverlay,
+		timingsOverlay,
+		netplayOverlay, //Only with GGPO.
+		overlayCount
+	};
+	int overlay = noOverlay; //Render thread only.
+	FrameTimer simTimer;
+	FrameTimer renderTimer;
+	NetStats netStats;
 
 	SoundEffects sfx;
 		
@@ -53,12 +92,24 @@ private:
 	Player* players[2];
 	GGPOPlayerHandle playerHandle[2];
 	GGPOSession *ggpo = nullptr;
+	bool spectating;
+	std::unique_ptr<SpectatorServer> broadcaster; //Host only.
+	std::unique_ptr<SpectatorClient> spectatorStream;
 	glm::mat4 viewMatrix; //Camera view.
+	HitboxList hitboxes; //Of the last advanced frame.
 
 	State savedState;
 
+	//The simulation runs in its own thread at a fixed rate and hands a snapshot of each frame to the render loop.
+	FramePacer simPacer;
+	InputLatch inputLatch;
+	TripleBuffer<RenderSnapshot> snapshots;
+	bool backUnread = false; //The render thread never got the back snapshot, so its particle slice is still ours.
+	std::mutex commandMutex;
+	std::vector<std::function<void()>> commands; //Posted by the render thread, run by the simulation one between frames.
+
 public:
-	BattleScene(ENetHost *local);
+	BattleScene(ENetHost *local, bool spectating = false);
 	~BattleScene();
 	void SaveState(State &state);
 	void LoadState(State &state);
@@ -71,7 +122,11 @@ private:
 	glm::mat4 projection;
 
 	bool KeyHandle(const SDL_KeyboardEvent &e); //Returns false if it doesn't handle the event.
+	void PostCommand(std::function<void()> command);
+	void RunCommands();
+	void SimulationLoop(std::stop_token stop, bool replay, size_t inputSize, int playerId, GfxHandler &gfx);
 	void AdvanceFrame();
+	void PublishSnapshot(GfxHandler &gfx);
 	bool SetupGgpo(int playerId, const std::string &address);
 };
 
@@ -7,6 +7,8 @@
 
 #include "chara.h"
 #include "raw_input.h" //Used only by Character::ResolveHit
+#include <script_file.h>
+#include <trace.h>
 
 Character::Character(FixedPoint xPos, int side, BattleInterface& scene, sol::state &lua, std::vector<Sequence> &sequences, std::vector<Actor> &actorList) :
 Actor(sequences, lua, actorList),
@@ -18,7 +20,7 @@ scene(&scene)
 	SetSide(side);
 	hittable = true;
 	wallpushable = true;
-	//userData = lua.create_table();
+	isCharacter = true;
 	return;
 }
 
@@ -52,11 +54,12 @@ void Character::BoundaryCollision()
 		accel.x.value = bounceVector.xAccel*speedMultiplier;
 		accel.y.value = bounceVector.yAccel*speedMultiplier;
 		pushTimer = bounceVector.maxPushBackTime;
-		GotoSequence(lua.get()["_seqTable"][bounceVector.sequenceName].get_or(-1));
+		GotoSequence(bounceVector.sequence);
 		touchedWall = 0;
 		hitstop = 6; 
 		scene->view.SetShakeTime(12);
-		scene->sfx.PlaySound("wallBounce");
+		static const int wallBounceSound = intern::Get("wallBounce");
+		scene->sfx.PlaySound(wallBounceSound);
 	}
 	else if (touchedWall == target->touchedWall) //Someone already has the wall.
 		touchedWall = 0;
@@ -119,19 +122,20 @@ int Character::ResolveHit(int keypress, Actor *hitter, bool AlwaysBlock)
 			blocked	= true;
 			isAlreadyBlocking = true;
 			blockTime = hitData->blockstun;
-			scene->sfx.PlaySound("block");
+			static const int blockSound = intern::Get("block");
+			scene->sfx.PlaySound(blockSound);
 			retType = hitType::blocked;
 			if(groundedState)
 				state = keypress & key::buf::DOWN ? state::crouch : state::stand;
 		}
 	}
 
-	if(hitData->vectorTables.count(state) == 0)
+	if(!hitData->HasVectors(state))
 		state = 0; //TODO: Fallback state from lua?
-	if(hitData->vectorTables.count(state) > 0)
+	if(hitData->HasVectors(state))
 	{
 		auto &vt = hitData->vectorTables[state][blocked];
-		int seq = lua.get()["_seqTable"][vt.sequenceName].get_or(-1);
+		int seq = vt.sequence;
 		if(seq > 0)
 		{
 			vel.x.value = vt.xSpeed*speedMultiplier*hitter->side;
@@ -148,7 +152,9 @@ int Character::ResolveHit(int keypress, Actor *hitter, bool AlwaysBlock)
 			if(!blocked) // No wall/floor bounce or other weird stuff on block. Should be a separate flag maybe.
 			{
 				hitFlags = hitData->attackFlags;
-				sol::optional<sol::table> t = lua.get()["_vectors"][vt.bounceTable];
+				sol::optional<sol::table> t;
+				if(vt.bounceTable != intern::none)
+					t = lua.get()["_vectors"][intern::String(vt.bounceTable)];
 				if(t)
 				{
 					bounceVector = hitData->getVectorTableFromTable(t.value());
@@ -170,12 +176,12 @@ int Character::ResolveHit(int keypress, Actor *hitter, bool AlwaysBlock)
 		hitstop = hitData->hitStop;
 		scene->view.SetShakeTime(hitData->shakeTime);
 		health -= hitData->damage;
-		if(!hitData->hitSound.empty())
-			scene->sfx.PlaySound(hitData->hitSound);
+		scene->sfx.PlaySound(hitData->hitSound);
 		if(framePointer->frameProp.chType > 0)
 		{
 			hitstop = hitstop*2 + 2 + 5*(framePointer->frameProp.state == state::air);
-			scene->sfx.PlaySound("counter");
+			static const int counterSound = intern::Get("counter");
+			scene->sfx.PlaySound(counterSound);
 			retType = hitType::counter;
 		}
 	}
@@ -294,9 +300,10 @@ bool Character::Update()
 			accel.x.value = bounceVector.xAccel*speedMultiplier;
 			accel.y.value = bounceVector.yAccel*speedMultiplier;
 			pushTimer = bounceVector.maxPushBackTime;
-			GotoSequence(lua.get()["_seqTable"][bounceVector.sequenceName].get_or(-1));
+			GotoSequence(bounceVector.sequence);
 			scene->view.SetShakeTime(12);
-			scene->sfx.PlaySound("bounce");
+			static const int bounceSound = intern::Get("bounce");
+			scene->sfx.PlaySound(bounceSound);
 		}
 		else
 			GotoFrame(landingFrame);
@@ -457,14 +464,21 @@ scene(scene)
 
 void Player::Load(int side, std::string charFile, int paletteSlot, bool ai)
 {
+	TRACE_ZONE("Player::Load");
 	charObj = new Character(FixedPoint(50*-side), side, scene, lua, sequences, newChildren);
 	charObj->paletteIndex = paletteSlot;
 	
 	aiPlayer = ai;
-	if(!ScriptSetup(ai))
-		abort();
+	{
+		TRACE_ZONE("Player::ScriptSetup");
+		if(!ScriptSetup(ai))
+			abort();
+	}
 	cmd.LoadFromLua("data/char/vaki/moves.lua", lua);
-	LoadSequences(sequences, charFile, lua); //Sequences refer to script.
+	{
+		TRACE_ZONE_DETAIL("LoadSequences", charFile);
+		LoadSequences(sequences, charFile, lua); //Sequences refer to script.
+	}
 
 	charObj->GotoSequence(0);
 	charObj->GotoFrame(0);
@@ -555,6 +569,9 @@ bool Player::ScriptSetup(bool ai)
 	key["left"] = key::buf::LEFT;
 	key["right"] = key::buf::RIGHT;
 	key["any"] = key::buf::UP | key::buf::DOWN | key::buf::LEFT | key::buf::RIGHT;
+	auto sound = constant["sound"].get_or_create<sol::table>();
+	for(int handle : scene.sfx.Aliases())
+		sound[intern::String(handle)] = handle;
 
 	global.set_function("RandomChance", [this](uint64_t percent){
 		return (uint64_t)scene.rng.GetU() < (((uint64_t)(std::numeric_limits<uint32_t>::max())+1)/100)*percent;
@@ -565,10 +582,17 @@ bool Player::ScriptSetup(bool ai)
 	global.set_function("Random", [this](double min, double max) -> double{
 		return (double)scene.rng.GetU()/(double)std::numeric_limits<uint32_t>::max() * (max-min) + min;
 	});
-	global.set_function("PlaySound", [this](std::string audioString){scene.sfx.PlaySound(audioString);});
+	//Takes a handle from constant.sound, or an alias as a slower fallback.
+	global.set_function("PlaySound", sol::overload(
+		[this](int handle){scene.sfx.PlaySound(handle);},
+		[this](const std::string &alias){scene.sfx.PlaySound(alias);}
+	));
 	global.set_function("DamageTarget", [this](int amount){target->health -= amount;});
 	global.set_function("ParticlesNormalRel", [this](int amount, float x, float y){
-		scene.particles.PushNormalHit(amount, (float)charObj->root.x+x*charObj->side, float(charObj->root.y)+y);
+		scene.particles.Emit("normalHit", amount, (float)charObj->root.x+x*charObj->side, float(charObj->root.y)+y);
+	});
+	global.set_function("ParticlesRel", [this](const std::string &emitter, int amount, float x, float y){
+		scene.particles.Emit(emitter, amount, (float)charObj->root.x+x*charObj->side, float(charObj->root.y)+y);
 	});
 	global.set_function("GetTarget", [this]()->Actor&{return *charObj->target;});
 	global.set_function("SetPriority", [this](int p){
@@ -596,7 +620,7 @@ bool Player::ScriptSetup(bool ai)
 	global.set_function("GetWhiffed", [this](){return charObj->whiffed;});
 
 	lua.create_named_table("G");
-	auto result = lua.script_file("data/char/vaki/script.lua");
+	auto result = ScriptFile(lua, "data/char/vaki/script.lua");
 	if(!result.valid()){
 		sol::error err = result;
 		std::cerr << "The code has failed to run in script.lua!\n"
@@ -612,7 +636,7 @@ bool Player::ScriptSetup(bool ai)
 
 	if(ai)
 	{
-		auto result = lua.script_file("data/char/vaki/ai.lua");
+		auto result = ScriptFile(lua, "data/char/vaki/ai.lua");
 		if(!result.valid()){
 			sol::error err = result;
 			std::cerr << "The code has failed to run in ai.lua!\n"
@@ -639,7 +663,7 @@ void Player::SetTarget(Player &t)
 	charObj->target = target;
 }
 
-void Player::Update(HitboxRenderer *hr)
+void Player::Update(HitboxList *boxes)
 {
 	if(hasUpdateFunction)
 	{
@@ -651,14 +675,14 @@ void Player::Update(HitboxRenderer *hr)
 		}
 	}
 
-	if(charObj->Update() && hr)
-		charObj->SendHitboxData(*hr);
+	if(charObj->Update() && boxes)
+		charObj->SendHitboxData(*boxes);
 	for(auto it = children.begin(); it != children.end();)
 	{
 		if((*it).Update())
 		{
-			if(hr)
-				(*it).SendHitboxData(*hr);
+			if(boxes)
+				(*it).SendHitboxData(*boxes);
 			++it;
 		}
 		else
@@ -672,8 +696,8 @@ void Player::Update(HitboxRenderer *hr)
 		if((*it).Update())
 		{
 			children.push_back(std::move(*it));
-			if(hr)
-				(*it).SendHitboxData(*hr);
+			if(boxes)
+				(*it).SendHitboxData(*boxes);
 			++it;
 		}
 		else
@@ -786,11 +810,11 @@ void Player::HitCollision(Player &bluePlayer, Player &redPlayer)
 					}
 					else if(blue->comboType == Actor::hurt && particleAmount > 0)
 					{
-						bluePlayer.scene.particles.PushNormalHit(particleAmount, result.second.x, result.second.y);
+						bluePlayer.scene.particles.Emit("normalHit", particleAmount, result.second.x, result.second.y);
 					}
 					else if(blue->comboType == Actor::counter && particleAmount > 0)
 					{
-						bluePlayer.scene.particles.PushCounterHit(particleAmount, result.second.x, result.second.y);
+						bluePlayer.scene.particles.Emit("counterHit", particleAmount, result.second.x, result.second.y);
 					}
 					blue->hitCount--;
 				}
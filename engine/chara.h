@@ -19,6 +19,7 @@ class Character : public Actor
 {
 private:
 	friend class Player;
+	friend class Actor;
 	Character *target = nullptr;
 	Actor *wallPushbackTarget = nullptr;
 	//sol::state lua;
@@ -123,7 +124,7 @@ public:
 	PlayerStateCopy GetStateCopy();
 
 	void SetTarget(Player &target);
-	void Update(HitboxRenderer *hr);
+	void Update(HitboxList *boxes);
 	int FillDrawList(DrawList &dl); //Returns player object index in the drawlist
 	void ProcessInput(InputBuffer inputs);
 	Point2d<FixedPoint> GetXYCoords();
@@ -3,6 +3,8 @@
 #include "command_inputs.h"
 #include "raw_input.h"
 #include "chara.h"
+#include <script_file.h>
+#include <trace.h>
 #include <deque>
 
 constexpr int chargeBufSize = 32;
@@ -58,7 +60,8 @@ int ChargeState::GetCharge(dir which, int frame, int side) const
 
 void CommandInputs::LoadFromLua(std::filesystem::path defFile, sol::state &lua)
 {
-	auto result = lua.script_file(defFile.string());
+	TRACE_ZONE("CommandInputs::LoadFromLua");
+	auto result = ScriptFile(lua, defFile);
 	if(!result.valid()){
 		sol::error err = result;
 		std::cerr << "The code has failed to run!\n"
@@ -0,0 +1,147 @@
+#include "frame_pacer.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <thread>
+
+//#define GENERIC_SLEEP
+#if defined (_WIN32) && !defined(GENERIC_SLEEP)
+	#include <windows.h>
+	#include <timeapi.h>
+#elif defined(__unix__) && !defined(GENERIC_SLEEP)
+	#include <time.h>
+	#include <errno.h>
+#endif
+
+using namespace std::chrono_literals;
+
+//Limits for how long before the deadline it stops sleeping.
+constexpr FramePacer::Clock::duration minSpin = 50us;
+constexpr FramePacer::Clock::duration maxSpin = 4ms;
+
+void FramePacer::Histogram::Add(Clock::duration value)
+{
+	auto bin = value/binWidth + binCount/2;
+	bins[std::clamp<decltype(bin)>(bin, 0, binCount-1)]++;
+}
+
+bool FramePacer::Histogram::WriteCsv(const std::filesystem::path &file) const
+{
+	std::ofstream out(file);
+	if(!out.is_open())
+	{
+		std::cerr << "Can't write jitter histogram to " << file << "\n";
+		return false;
+	}
+	out << "jitter us,frames\n";
+	for(int i = 0; i < binCount; ++i)
+		out << (i - binCount/2)*binWidth.count() << "," << bins[i] << "\n";
+	out << "resyncs," << resyncs << "\n";
+	return !out.fail();
+}
+
+#if defined (_WIN32) && !defined(GENERIC_SLEEP)
+static UINT GetMinTimer(){
+	TIMECAPS tc;
+	timeGetDevCaps(&tc, sizeof(tc));
+	return tc.wPeriodMin;
+};
+static UINT minTimer = GetMinTimer();
+
+FramePacer::FramePacer():
+spinThreshold(2ms)
+{
+	timeBeginPeriod(minTimer);
+	SetPeriod(1.0/60.0);
+	deadline = lastWake = Clock::now();
+}
+
+FramePacer::~FramePacer()
+{
+	timeEndPeriod(minTimer);
+}
+
+void FramePacer::SleepUntil(Clock::time_point target)
+{
+	auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(target - Clock::now()).count();
+	if(ms > 0)
+		Sleep(ms);
+}
+#else
+FramePacer::FramePacer():
+spinThreshold(500us)
+{
+	SetPeriod(1.0/60.0);
+	deadline = lastWake = Clock::now();
+}
+
+FramePacer::~FramePacer() = default;
+
+#if defined(__unix__) && !defined(GENERIC_SLEEP)
+//steady_clock is CLOCK_MONOTONIC, so its time points can be used as absolute deadlines directly.
+void FramePacer::SleepUntil(Clock::time_point target)
+{
+	auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(target.time_since_epoch()).count();
+	timespec ts{
+		.tv_sec = (time_t)(ns / 1'000'000'000),
+		.tv_nsec = (long)(ns % 1'000'000'000),
+	};
+	while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR);
+}
+#else
+void FramePacer::SleepUntil(Clock::time_point target)
+{
+	std::this_thread::sleep_until(target);
+}
+#endif
+#endif
+
+void FramePacer::SetPeriod(double seconds)
+{
+	period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+}
+
+void FramePacer::Wait(bool uncapped, const std::function<void()> &poll)
+{
+	auto now = Clock::now();
+	if(!uncapped)
+	{
+		deadline += period;
+		if(now > deadline + period) //Too far behind to catch up. Start counting from here.
+		{
+			deadline = now;
+			jitter.resyncs++;
+		}
+
+		auto wakeTarget = deadline - spinThreshold;
+		if(poll)
+		{
+			while(now + pollInterval < wakeTarget)
+			{
+				SleepUntil(now + pollInterval);
+				poll();
+				now = Clock::now();
+			}
+		}
+		if(now < wakeTarget)
+		{
+			SleepUntil(wakeTarget);
+			now = Clock::now();
+
+			//Decaying peak of how late the OS wakes us. Waking up late makes the next sleeps shorter.
+			auto wakeError = std::max(now - wakeTarget, Clock::duration::zero());
+			wakeErrorPeak = std::max(wakeError, wakeErrorPeak - wakeErrorPeak/64);
+			spinThreshold = std::clamp(wakeErrorPeak + wakeErrorPeak/4 + minSpin, minSpin, maxSpin);
+		}
+
+		while((now = Clock::now()) < deadline)
+			std::this_thread::yield();
+	}
+	else
+		deadline = now;
+
+	interval = now - lastWake;
+	lastWake = now;
+	if(!uncapped)
+		jitter.Add(interval - period);
+}
@@ -0,0 +1,57 @@
+#ifndef FRAME_PACER_H_GUARD
+#define FRAME_PACER_H_GUARD
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+
+//Waits for absolute deadlines one period apart, so lateness in one frame doesn't push back the next ones.
+//Sleeps until shortly before the deadline and spins the rest. How early it wakes up depends on how late
+//the OS has been waking it up so far.
+class FramePacer
+{
+public:
+	using Clock = std::chrono::steady_clock;
+
+	//Frame interval minus the period, in binWidth steps. The first and last bins also count everything past them.
+	struct Histogram
+	{
+		static constexpr int binCount = 41;
+		static constexpr std::chrono::microseconds binWidth{100};
+		std::array<uint64_t, binCount> bins{};
+		uint64_t resyncs = 0; //Times it fell more than a period behind and dropped the missed deadlines.
+
+		void Add(Clock::duration jitter);
+		bool WriteCsv(const std::filesystem::path &file) const;
+	};
+
+	FramePacer();
+	~FramePacer();
+
+	static constexpr std::chrono::milliseconds pollInterval{1};
+
+	void SetPeriod(double seconds);
+	//Returns when the next frame is due. If given, poll is called about every pollInterval while it sleeps.
+	void Wait(bool uncapped = false, const std::function<void()> &poll = nullptr);
+
+	double Interval() const { return std::chrono::duration<double>(interval).count(); } //Seconds since the previous Wait returned.
+	Clock::duration SpinThreshold() const { return spinThreshold; }
+	const Histogram &Jitter() const { return jitter; }
+
+private:
+	Clock::duration period;
+	Clock::time_point deadline;
+	Clock::time_point lastWake;
+	Clock::duration interval{};
+
+	Clock::duration spinThreshold;
+	Clock::duration wakeErrorPeak{};
+
+	Histogram jitter;
+
+	void SleepUntil(Clock::time_point target);
+};
+
+#endif /* FRAME_PACER_H_GUARD */
@@ -0,0 +1,168 @@
+#include "frame_timer.h"
+#include "hud.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+
+const char *FrameTimer::phaseNames[phaseCount] = {
+	"events",
+	"ggpo idle",
+	"ggpo sync",
+	"hit collision",
+	"input",
+	"update",
+	"collision",
+	"camera",
+	"particles",
+	"publish",
+	"record",
+	"submit",
+	"sleep",
+};
+
+//Grays are pacing, greens simulation and blues rendering.
+static constexpr float phaseColors[FrameTimer::phaseCount][3] = {
+	{0.6, 0.6, 0.6},
+	{0.9, 0.8, 0.3},
+	{0.8, 0.55, 0.2},
+	{0.1, 0.5, 0.1},
+	{0.3, 0.8, 0.3},
+	{0.1, 0.9, 0.1},
+	{0.5, 0.9, 0.5},
+	{0.2, 0.6, 0.4},
+	{0.6, 1.0, 0.2},
+	{0.0, 0.7, 0.7},
+	{0.2, 0.4, 1.0},
+	{0.5, 0.3, 0.9},
+	{0.25, 0.25, 0.25},
+};
+
+FrameTimer::Scope::Scope(FrameTimer &timer, Phase phase):
+timer(&timer), phase(phase), parent(timer.active), start(Clock::now())
+{
+	timer.active = this;
+}
+
+void FrameTimer::Scope::End()
+{
+	if(!timer)
+		return;
+	auto elapsed = Clock::now() - start;
+	if(parent)
+		parent->nested += elapsed;
+	timer->samples[timer->current][phase] += std::chrono::duration<float, std::milli>(elapsed - nested).count();
+	timer->active = parent;
+	timer = nullptr;
+}
+
+void FrameTimer::NextFrame()
+{
+	std::lock_guard lock(mutex);
+	current = (current + 1) % historySize;
+	std::fill(std::begin(samples[current]), std::end(samples[current]), 0.f);
+	frames = std::min(frames + 1, historySize - 1);
+}
+
+float FrameTimer::Get(int age, Phase phase) const
+{
+	std::lock_guard lock(mutex);
+	return Sample(age, phase);
+}
+
+float FrameTimer::Percentile(Phase phase, float percent) const
+{
+	std::lock_guard lock(mutex);
+	return SamplePercentile(phase, percent);
+}
+
+int FrameTimer::Frames() const
+{
+	std::lock_guard lock(mutex);
+	return frames;
+}
+
+float FrameTimer::Sample(int age, Phase phase) const
+{
+	return samples[(current - 1 - age + historySize) % historySize][phase];
+}
+
+float FrameTimer::SamplePercentile(Phase phase, float percent) const
+{
+	if(frames == 0)
+		return 0;
+	float values[historySize];
+	for(int i = 0; i < frames; ++i)
+		values[i] = Sample(i, phase);
+	int nth = std::min(frames - 1, (int)(frames*percent/100.f));
+	std::nth_element(values, values + nth, values + frames);
+	return values[nth];
+}
+
+void FrameTimer::DrawOverlay(Hud &hud, float y0) const
+{
+	constexpr float x0 = 8;
+	constexpr float msHeight = 3; //HUD units per millisecond.
+	constexpr float maxMs = 34;
+	constexpr float budgetMs = 1000.f/60.f;
+	constexpr float background[3] = {0.05, 0.05, 0.05};
+	constexpr float white[3] = {1, 1, 1};
+
+	std::lock_guard lock(mutex);
+	//Stacked history, newest on the right.
+	hud.AddOverlayQuad(x0, y0, historySize, maxMs*msHeight, background);
+	for(int age = 0; age < frames; ++age)
+	{
+		float x = x0 + historySize - 1 - age;
+		float total = 0;
+		for(int phase = 0; phase < phaseCount && total < maxMs; ++phase)
+		{
+			float ms = std::min(Sample(age, (Phase)phase), maxMs - total);
+			if(ms <= 0)
+				continue;
+			hud.AddOverlayQuad(x, y0 + total*msHeight, 1, ms*msHeight, phaseColors[phase]);
+			total += ms;
+		}
+	}
+	hud.AddOverlayQuad(x0, y0 + budgetMs*msHeight, historySize, 0.5, white);
+
+	//p99 of every phase as a bar on the same scale, with the frame budget marked.
+	float legendX = x0 + historySize + 6;
+	constexpr int rowHeight = 8;
+	hud.AddOverlayQuad(legendX - 2, y0, maxMs*msHeight + 10, phaseCount*rowHeight, background);
+	for(int phase = 0; phase < phaseCount; ++phase)
+	{
+		float y = y0 + (phaseCount - 1 - phase)*rowHeight + 1;
+		float ms = std::min(SamplePercentile((Phase)phase, 99), maxMs);
+		hud.AddOverlayQuad(legendX, y, 4, rowHeight - 2, phaseColors[phase]);
+		hud.AddOverlayQuad(legendX + 6, y, std::max(ms*msHeight, 0.5f), rowHeight - 2, phaseColors[phase]);
+	}
+	hud.AddOverlayQuad(legendX + 6 + budgetMs*msHeight, y0, 0.5, phaseCount*rowHeight, white);
+}
+
+bool FrameTimer::WriteCsv(const std::filesystem::path &file) const
+{
+	std::ofstream out(file);
+	if(!out.is_open())
+	{
+		std::cerr << "Can't write frame times to " << file << "\n";
+		return false;
+	}
+
+	std::lock_guard lock(mutex);
+	out << "frame";
+	for(auto name : phaseNames)
+		out << "," << name;
+	out << "\n";
+	for(int age = frames - 1; age >= 0; --age)
+	{
+		out << frames - 1 - age;
+		for(int phase = 0; phase < phaseCount; ++phase)
+			out << "," << Sample(age, (Phase)phase);
+		out << "\n";
+	}
+	out << "p99";
+	for(int phase = 0; phase < phaseCount; ++phase)
+		out << "," << SamplePercentile((Phase)phase, 99);
+	out << "\n";
+	return !out.fail();
+}
@@ -0,0 +1,75 @@
+#ifndef FRAME_TIMER_H_GUARD
+#define FRAME_TIMER_H_GUARD
+
+#include <chrono>
+#include <filesystem>
+#include <mutex>
+
+class Hud;
+
+//Time spent in each part of a loop over the last historySize frames.
+class FrameTimer
+{
+public:
+	enum Phase
+	{
+		events,
+		ggpoIdle,
+		ggpoSync,
+		hitCollision,
+		input,
+		update,
+		collision,
+		camera,
+		particles,
+		publish,
+		record,
+		submit,
+		sleep,
+		phaseCount
+	};
+	static const char *phaseNames[phaseCount];
+	static constexpr int historySize = 256;
+
+	using Clock = std::chrono::steady_clock;
+
+	//Adds the time until End or destruction to the phase. Rollbacks can run a phase several times in a frame.
+	//Time spent in nested scopes only counts for the inner one. Only from the thread that calls NextFrame.
+	class Scope
+	{
+	public:
+		Scope(FrameTimer &timer, Phase phase);
+		~Scope() { End(); }
+		void End();
+
+	private:
+		FrameTimer *timer;
+		Phase phase;
+		Scope *parent;
+		Clock::time_point start;
+		Clock::duration nested{};
+	};
+
+	//Call once per loop iteration. The rest can be called from other threads.
+	void NextFrame();
+	float Get(int age, Phase phase) const; //Milliseconds. Age 0 is the last finished frame.
+	float Percentile(Phase phase, float percent) const;
+	int Frames() const;
+
+	//Stacked graph of the history and the p99 of each phase. y0 is the top in HUD units.
+	void DrawOverlay(Hud &hud, float y0 = 8) const;
+	bool WriteCsv(const std::filesystem::path &file) const;
+
+private:
+	//Finished rows only change in NextFrame, so scopes write the current one without locking.
+	mutable std::mutex mutex;
+	float samples[historySize][phaseCount] = {};
+	int current = 0; //Row being filled.
+	int frames = 0; //Finished rows, up to historySize-1.
+	Scope *active = nullptr;
+
+	float Sample(int age, Phase phase) const;
+	float SamplePercentile(Phase phase, float percent) const;
+};
+
+#endif /* FRAME_TIMER_H_GUARD */
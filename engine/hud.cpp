@@ -1,5 +1,7 @@
 #include "hud.h"
 #include "window.h"
+#include <script_file.h>
+#include <trace.h>
 #include <sol/sol.hpp>
 #include <iostream>
 #include <unordered_set>
@@ -21,9 +23,10 @@ vao(renderer)
 
 void Hud::Load(std::filesystem::path file)
 {
+	TRACE_ZONE("Hud::Load");
 	sol::state lua;
 	lua.open_libraries(sol::lib::base);
-	auto result = lua.script_file(file.string());
+	auto result = ScriptFile(lua, file);
 	if(!result.valid()){
 		sol::error err = result;
 		std::cerr << "When loading " << file <<"\n";
@@ -179,11 +182,26 @@ void Hud::CreatePipeline()
 	}, 0, 0});
 
 	pBuilder.UpdateSets(updateSetParams);
+
+	auto overlayBuilder = renderer.GetPipelineBuilder();
+	overlayBuilder
+		.SetShaders("data/spirv/box.vert.bin", "data/spirv/box.frag.bin")
+		.SetInputLayout(true, {vk::Format::eR32G32B32Sfloat, vk::Format::eR32G32B32Sfloat})
+		.SetPushConstants({
+			{.stageFlags = vk::ShaderStageFlagBits::eVertex, .size = sizeof(OverlayConstants)},
+		})
+	;
+	auto &blend = overlayBuilder.colorBlendAttachment;
+	blend.srcColorBlendFactor = vk::BlendFactor::eSrcAlpha;
+	blend.dstColorBlendFactor = vk::BlendFactor::eOneMinusSrcAlpha;
+	overlayPipeline = overlayBuilder.Build(overlayPipeset);
+	overlayVertices.Allocate(&renderer, sizeof(OverlayVertex)*6*maxOverlayQuads, vk::BufferUsageFlagBits::eVertexBuffer,
+		vma::MemoryUsage::eCpuToGpu, renderer.bufferedFrames);
 }
 
-void Hud::Draw()
+void Hud::Draw(int layer)
 {
-	auto cmd = renderer.GetCommand();
+	auto cmd = renderer.GetCommand(layer);
 	if(!cmd)
 		return;
 
@@ -194,6 +212,16 @@ void Hud::Draw()
 	}, nullptr);
 	cmd->pushConstants(*pipeset.layout, vk::ShaderStageFlagBits::eVertex, 0, sizeof(pushConstants), &pushConstants);
 	cmd->draw(staticCount, 1, location, 0);	
+
+	if(overlayQuads > 0)
+	{
+		OverlayConstants constants{pushConstants.transform, 0.8f};
+		cmd->bindPipeline(vk::PipelineBindPoint::eGraphics, *overlayPipeline);
+		cmd->bindVertexBuffers(0, overlayVertices.buffer, overlayVertices.copySize*renderer.CurrentFrame());
+		cmd->pushConstants(*overlayPipeset.layout, vk::ShaderStageFlagBits::eVertex, 0, sizeof(constants), &constants);
+		cmd->draw(overlayQuads*6, 1, 0, 0);
+		overlayQuads = 0;
+	}
 }
 
 void Hud::ResizeBarId(int id, float horizPercentage)
@@ -227,4 +255,14 @@ void Hud::ResizeBarId(int id, float horizPercentage)
 void Hud::SetMatrix(const glm::mat4 &matrix)
 {
 	pushConstants.transform = matrix;
+}
+
+void Hud::AddOverlayQuad(float x, float y, float w, float h, const float color[3])
+{
+	if(overlayQuads >= maxOverlayQuads)
+		return;
+	auto vertices = (OverlayVertex*)overlayVertices.Map(renderer.CurrentFrame()) + overlayQuads*6;
+	for(int i = 0; i < 6; ++i)
+		vertices[i] = {x + w*tX[i], y + h*tY[i], 1, color[0], color[1], color[2]};
+	overlayQuads++;
 }
\ No newline at end of file
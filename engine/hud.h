@@ -31,6 +31,14 @@ class Hud
 	struct{
 		glm::mat4 transform;
 	} pushConstants;
+
+	struct OverlayVertex{
+		float x,y,z,r,g,b;
+	};
+	struct OverlayConstants{
+		glm::mat4 transform;
+		float alpha;
+	};
 	
 	float gScale;
 	float width;
@@ -47,15 +55,25 @@ class Hud
 	Renderer &renderer;
 	Renderer::Texture texture;
 
+	//Flat colored quads drawn with the hitbox shaders over everything else.
+	vk::raii::Pipeline overlayPipeline = nullptr;
+	PipeSet overlayPipeset;
+	AllocatedBuffer overlayVertices;
+	int overlayQuads = 0;
+
 	void CreatePipeline();
 
 public:
+	static constexpr int maxOverlayQuads = 4096;
+
 	Hud(Renderer *renderer);
 	Hud(Renderer *renderer, std::filesystem::path file);
 	void Load(std::filesystem::path file);
-	void Draw();
+	void Draw(int layer = 0);
 	void ResizeBarId(int id, float horizPercentage); 
 	void SetMatrix(const glm::mat4 &matrix);
+	//In HUD coordinates. Overlay quads are only drawn by the next Draw.
+	void AddOverlayQuad(float x, float y, float w, float h, const float color[3]);
 };
 
 #endif // HUD_H_INCLUDED
@@ -0,0 +1,75 @@
+#include "input_latch.h"
+#include "raw_input.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+
+//Directions only use the latest state. Holding both sides for a frame after a quick switch would read as a different input.
+constexpr unsigned int tapMask = key::buf::A | key::buf::B | key::buf::C | key::buf::D;
+
+void InputLatch::Latch(unsigned int out[2])
+{
+	auto now = Clock::now();
+	unsigned int tapped[2] = {};
+	bool changed = false;
+	Clock::time_point oldest;
+
+	InputSample sample;
+	while(inputSamples.Pop(sample))
+	{
+		if(!changed)
+			oldest = sample.time;
+		changed = true;
+		tapped[0] |= sample.keys[0];
+		tapped[1] |= sample.keys[1];
+	}
+
+	for(int i = 0; i < 2; ++i)
+		out[i] = keySend[i] | (tapped[i] & tapMask);
+
+	if(changed)
+	{
+		latencies[current] = std::chrono::duration<float, std::milli>(now - oldest).count();
+		current = (current + 1) % historySize;
+		count = std::min(count + 1, historySize);
+	}
+}
+
+void InputLatch::Start()
+{
+	InputSample sample;
+	while(inputSamples.Pop(sample));
+}
+
+float InputLatch::Latency(int age) const
+{
+	return latencies[(current - 1 - age + historySize) % historySize];
+}
+
+float InputLatch::Percentile(float percent) const
+{
+	if(count == 0)
+		return 0;
+	float values[historySize];
+	for(int i = 0; i < count; ++i)
+		values[i] = Latency(i);
+	int nth = std::min(count - 1, (int)(count*percent/100.f));
+	std::nth_element(values, values + nth, values + count);
+	return values[nth];
+}
+
+bool InputLatch::WriteCsv(const std::filesystem::path &file) const
+{
+	std::ofstream out(file);
+	if(!out.is_open())
+	{
+		std::cerr << "Can't write input latency to " << file << "\n";
+		return false;
+	}
+	out << "latch,latency ms\n";
+	for(int age = count - 1; age >= 0; --age)
+		out << count - 1 - age << "," << Latency(age) << "\n";
+	out << "p50," << Percentile(50) << "\n";
+	out << "p99," << Percentile(99) << "\n";
+	return !out.fail();
+}
@@ -0,0 +1,33 @@
+#ifndef INPUT_LATCH_H_GUARD
+#define INPUT_LATCH_H_GUARD
+
+#include <chrono>
+#include <filesystem>
+
+//Turns the queued key transitions into one input word per player each simulated frame.
+//Simulation thread only.
+class InputLatch
+{
+public:
+	using Clock = std::chrono::steady_clock;
+	static constexpr int historySize = 256;
+
+	//Takes the current keys. Buttons that were pressed and released since the last call count as held.
+	//Records how long the oldest transition waited to be latched.
+	void Latch(unsigned int out[2]);
+	//Drops the transitions queued before the match, from menus or while loading.
+	//Otherwise the first latch would count them as taps and record how long they waited.
+	void Start();
+
+	float Latency(int age) const; //Milliseconds. Age 0 is the last latch that had a transition.
+	float Percentile(float percent) const;
+	int Count() const { return count; }
+	bool WriteCsv(const std::filesystem::path &file) const;
+
+private:
+	float latencies[historySize] = {};
+	int current = 0; //Next slot to write.
+	int count = 0; //Filled slots, up to historySize.
+};
+
+#endif /* INPUT_LATCH_H_GUARD */
@@ -5,6 +5,8 @@
 #include "game_state.h"
 
 #include "netplay.h"
+#include <vfs.h>
+#include <trace.h>
 #include <enet/enet.h>
 #include <fstream>
 #include <SDL_gamecontroller.h>
@@ -40,9 +42,14 @@ int main(int argc, char** argv)
 		}
 	}
 
+	TRACE_THREAD("Main");
+	//Loose files under data/ are used for anything the archive doesn't have.
+	vfs::Mount("data.afa");
+
 	mainWindow = new Window();
 	soloud = new SoLoud::Soloud;
 	soloud->init();
+	music = new Music;
 	
 	//TODO: Move
 		std::ifstream keyfile("keyconf.bin", std::ifstream::in | std::ifstream::binary);
@@ -82,7 +89,7 @@ int main(int argc, char** argv)
 					int playerId = 0;
 					if(netState == net::Joining)
 						playerId = 1;
-					BattleScene bs(local);
+					BattleScene bs(local, netState == net::Spectating);
 					gameState = bs.PlayLoop(playDemo, aiMatch, playerId, address);
 					break;
 				}
@@ -106,6 +113,7 @@ int main(int argc, char** argv)
 
 	if(netState)
 		enet_deinitialize();
+	delete music;
 	soloud->deinit();
 	delete soloud;
 	delete mainWindow;
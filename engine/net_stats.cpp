@@ -0,0 +1,175 @@
+#include "net_stats.h"
+#include "hud.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+
+static float Milliseconds(NetStats::Clock::duration time)
+{
+	return std::chrono::duration<float, std::milli>(time).count();
+}
+
+void NetStats::Rollback(Clock::duration loadTime)
+{
+	step.rollbacks++;
+	step.rollbackMs += Milliseconds(loadTime);
+}
+
+void NetStats::Resimulated(Clock::duration time)
+{
+	step.depth++;
+	step.rollbackMs += Milliseconds(time);
+}
+
+void NetStats::StartSimulating()
+{
+	rollbackMsAtStart = step.rollbackMs;
+	simStart = Clock::now();
+}
+
+void NetStats::StopSimulating()
+{
+	float rolledBack = step.rollbackMs - rollbackMsAtStart;
+	step.simMs += std::max(0.f, Milliseconds(Clock::now() - simStart) - rolledBack);
+}
+
+void NetStats::EndStep(int32_t frame, const GGPONetworkStats &network)
+{
+	step.frame = frame;
+	step.ping = network.network.ping;
+	step.localAdvantage = -network.timesync.local_frames_behind;
+	step.remoteAdvantage = -network.timesync.remote_frames_behind;
+	step.predicted = network.sync.predicted_frames;
+	step.sendQueue = network.network.send_queue_len;
+	step.kbps = network.network.kbps_sent;
+	{
+		std::lock_guard lock(mutex);
+		samples.push_back(step);
+	}
+	step = {};
+}
+
+int NetStats::Steps() const
+{
+	std::lock_guard lock(mutex);
+	return samples.size();
+}
+
+void NetStats::DrawOverlay(Hud &hud, float y0) const
+{
+	constexpr float x0 = 8;
+	constexpr float gap = 6;
+	constexpr float msHeight = 2;
+	constexpr float maxMs = 34;
+	constexpr float budgetMs = 1000.f/60.f;
+	constexpr float frameHeight = 4; //Per rolled back frame.
+	constexpr float maxPing = 200;
+	constexpr float pingHeight = 0.2; //Per millisecond.
+	constexpr float advantageHeight = 2.5; //Per frame, both ways from the middle.
+	constexpr float background[3] = {0.05, 0.05, 0.05};
+	constexpr float white[3] = {1, 1, 1};
+	constexpr float simColor[3] = {0.1, 0.9, 0.1};
+	constexpr float rollbackColor[3] = {0.9, 0.2, 0.2};
+	constexpr float depthColor[3] = {0.9, 0.6, 0.1};
+	constexpr float pingColor[3] = {0.6, 0.6, 0.6};
+	constexpr float localColor[3] = {0.2, 0.4, 1.0};
+	constexpr float remoteColor[3] = {0.5, 0.3, 0.9};
+
+	const float timeY = y0;
+	const float depthY = timeY + maxMs*msHeight + gap;
+	const float depthH = GGPO_MAX_PREDICTION_FRAMES*frameHeight;
+	const float pingY = depthY + depthH + gap;
+	const float pingH = maxPing*pingHeight;
+	const float advantageY = pingY + pingH + gap;
+	const float advantageH = GGPO_MAX_PREDICTION_FRAMES*advantageHeight*2;
+	const float advantageMid = advantageY + advantageH/2;
+
+	hud.AddOverlayQuad(x0, timeY, overlaySteps, maxMs*msHeight, background);
+	hud.AddOverlayQuad(x0, depthY, overlaySteps, depthH, background);
+	hud.AddOverlayQuad(x0, pingY, overlaySteps, pingH, background);
+	hud.AddOverlayQuad(x0, advantageY, overlaySteps, advantageH, background);
+
+	std::lock_guard lock(mutex);
+	//Newest on the right.
+	int count = std::min<int>(samples.size(), overlaySteps);
+	for(int age = 0; age < count; ++age)
+	{
+		auto &s = samples[samples.size() - 1 - age];
+		float x = x0 + overlaySteps - 1 - age;
+
+		float sim = std::min(s.simMs, maxMs);
+		float rollback = std::min(s.rollbackMs, maxMs - sim);
+		if(sim > 0)
+			hud.AddOverlayQuad(x, timeY, 1, sim*msHeight, simColor);
+		if(rollback > 0)
+			hud.AddOverlayQuad(x, timeY + sim*msHeight, 1, rollback*msHeight, rollbackColor);
+
+		if(s.depth > 0)
+			hud.AddOverlayQuad(x, depthY, 1, std::min(s.depth*frameHeight, depthH), depthColor);
+		if(s.ping > 0)
+			hud.AddOverlayQuad(x, pingY, 1, std::min(s.ping*pingHeight, pingH), pingColor);
+
+		auto advantage = [&](int frames)
+		{
+			return std::clamp<float>(frames, -GGPO_MAX_PREDICTION_FRAMES, GGPO_MAX_PREDICTION_FRAMES)*advantageHeight;
+		};
+		float local = advantage(s.localAdvantage);
+		if(local != 0)
+			hud.AddOverlayQuad(x, std::min(advantageMid, advantageMid - local), 1, std::abs(local), localColor);
+		hud.AddOverlayQuad(x, advantageMid - advantage(s.remoteAdvantage) - 0.5f, 1, 1, remoteColor);
+	}
+	hud.AddOverlayQuad(x0, timeY + budgetMs*msHeight, overlaySteps, 0.5, white);
+	hud.AddOverlayQuad(x0, advantageMid - 0.25f, overlaySteps, 0.5, white);
+}
+
+bool NetStats::WriteCsv(const std::filesystem::path &file) const
+{
+	std::ofstream out(file);
+	if(!out.is_open())
+	{
+		std::cerr << "Can't write netplay stats to " << file << "\n";
+		return false;
+	}
+
+	std::lock_guard lock(mutex);
+	out << "step,frame,ping ms,local advantage,remote advantage,predicted,send queue,kbps,rollbacks,depth,sim ms,rollback ms\n";
+	for(size_t i = 0; i < samples.size(); ++i)
+	{
+		auto &s = samples[i];
+		out << i << "," << s.frame << "," << s.ping << "," << s.localAdvantage << "," << s.remoteAdvantage << "," << s.predicted << ","
+			<< s.sendQueue << "," << s.kbps << "," << s.rollbacks << "," << s.depth << "," << s.simMs << "," << s.rollbackMs << "\n";
+	}
+	return !out.fail();
+}
+
+void NetStats::PrintSummary() const
+{
+	std::lock_guard lock(mutex);
+	if(samples.empty())
+		return;
+
+	int rollbacks = 0, depthSum = 0, maxDepth = 0;
+	double simMs = 0, rollbackMs = 0;
+	std::vector<int> pings;
+	pings.reserve(samples.size());
+	for(auto &s : samples)
+	{
+		rollbacks += s.rollbacks;
+		depthSum += s.depth;
+		maxDepth = std::max(maxDepth, s.depth);
+		simMs += s.simMs;
+		rollbackMs += s.rollbackMs;
+		pings.push_back(s.ping);
+	}
+	auto percentile = [&](float percent)
+	{
+		int nth = std::min<int>(pings.size() - 1, pings.size()*percent/100.f);
+		std::nth_element(pings.begin(), pings.begin() + nth, pings.end());
+		return pings[nth];
+	};
+
+	std::cout << "Netplay: " << rollbacks << " rollbacks in " << samples.size() << " steps, "
+		<< (rollbacks ? (float)depthSum/rollbacks : 0) << " frames deep on average, " << maxDepth << " at most.\n"
+		<< "Ping p50: " << percentile(50) << "ms p99: " << percentile(99) << "ms. "
+		<< rollbackMs << "ms spent rolling back, " << simMs << "ms simulating new frames.\n";
+}
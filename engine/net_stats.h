@@ -0,0 +1,58 @@
+#ifndef NET_STATS_H_GUARD
+#define NET_STATS_H_GUARD
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <vector>
+#include <ggponet.h>
+
+class Hud;
+
+//What netplay did in each simulation step of a match: the connection as GGPO sees it, and how often and how far it rolled back.
+//Filled by the simulation thread. The rest can be called from other threads.
+class NetStats
+{
+public:
+	using Clock = std::chrono::steady_clock;
+	static constexpr int overlaySteps = 256;
+
+	struct Sample
+	{
+		int32_t frame; //gameTicks at the end of the step.
+		int ping; //Round trip in milliseconds.
+		int localAdvantage; //Frames ahead of the remote side.
+		int remoteAdvantage; //Frames the remote side thinks it's ahead of this one.
+		int predicted; //Frames run on predicted inputs.
+		int sendQueue; //Packets the remote side hasn't acknowledged yet.
+		int kbps;
+		int rollbacks; //States loaded.
+		int depth; //Frames simulated again.
+		float simMs; //Simulating new frames.
+		float rollbackMs; //Loading states and simulating frames again.
+	};
+
+	//Call these as the step goes, then EndStep.
+	void Rollback(Clock::duration loadTime);
+	void Resimulated(Clock::duration time);
+	//Around a new frame. GGPO may roll back inside it, and that time only counts as rollback time.
+	void StartSimulating();
+	void StopSimulating();
+	void EndStep(int32_t frame, const GGPONetworkStats &network);
+
+	int Steps() const;
+	//Simulation and rollback time, rollback depth, ping and frame advantage of the last overlaySteps. y0 is the top in HUD units.
+	void DrawOverlay(Hud &hud, float y0 = 8) const;
+	bool WriteCsv(const std::filesystem::path &file) const; //Every step of the match.
+	void PrintSummary() const;
+
+private:
+	mutable std::mutex mutex;
+	Sample step{};
+	Clock::time_point simStart;
+	float rollbackMsAtStart = 0;
+	std::vector<Sample> samples;
+};
+
+#endif /* NET_STATS_H_GUARD */
@@ -1,7 +1,9 @@
+#include <algorithm>
 #include <cstring>
 #include <iostream>
 
 #include <string>
+#include <vector>
 #include <enet/enet.h>
 
 #include "netplay.h"
@@ -9,6 +11,20 @@
 
 namespace net {
 
+int spectatorDelay = 120;
+
+bool IsHandshake(const ENetPacket *packet, const char *message)
+{
+	size_t size = strlen(message);
+	return packet->dataLength >= size && strncmp((const char*)packet->data, message, size) == 0;
+}
+
+void SendHandshake(ENetPeer *peer, int channel, const char *message)
+{
+	ENetPacket * packet = enet_packet_create (message, strlen(message), ENET_PACKET_FLAG_RELIABLE);
+	enet_peer_send(peer, channel, packet);
+}
+
 Result NetplayArgs(int argc, char** argv, ENetHost *&local, std::string &address_)
 {
 		if (enet_initialize() != 0) {
@@ -16,22 +32,41 @@ Result NetplayArgs(int argc, char** argv, ENetHost *&local, std::string &address
 			return FailedToInit;
 		}
 
+		std::vector<std::string> args(argv, argv + argc);
+		for(auto it = args.begin(); it != args.end(); ++it)
+		{
+			if(*it == "-delay" && it + 1 != args.end())
+			{
+				spectatorDelay = std::max(std::atoi((it + 1)->c_str()), 0);
+				args.erase(it, it + 2);
+				break;
+			}
+		}
+
 		bool success = false;
 		bool host = false;
+		bool spectate = false;
 		int inputDelay;
 		local = nullptr;
-		if(argc == 3)
+		if(args.size() == 4 && args[1] == "spectate")
+		{
+			std::cout << "Spectating " << args[2] << ":" << args[3] << "...\n";
+			success = Join(args[2], args[3], local);
+			address_ = args[2];
+			spectate = true;
+		}
+		else if(args.size() == 3)
 		{
-			std::string address(argv[1]);
-			std::string port(argv[2]);
+			std::string address(args[1]);
+			std::string port(args[2]);
 			std::cout << "Joining " << address << ":" << port << "...\n";
 			
 			success = Join(address, port, local);
 			address_ = std::move(address);
 		}
-		else if(argc == 2)
+		else if(args.size() == 2)
 		{
-			std::string port(argv[1]);
+			std::string port(args[1]);
 			std::cout << "Hosting at " << port << "...\n";
 			success = Host(port, local);
 			if(!local)
@@ -55,12 +90,15 @@ Result NetplayArgs(int argc, char** argv, ENetHost *&local, std::string &address
 		else
 		{
 			std::cout << "Something failed\n";
-			std::cout << "\nUsage: \tHosting: <port>\n\t\tJoining: <adress> <port>\n";
+			std::cout << "\nUsage: \tHosting: <port> [-delay <spectator delay in frames>]\n\t\tJoining: <adress> <port>\n"
+				"\t\tSpectating: spectate <adress> <port + 1>\n";
 			return FailedNeedsCleanup;
 		}
 
 	if(host)
 		return Hosting;
+	else if(spectate)
+		return Spectating;
 	else
 		return Joining;
 }
@@ -116,12 +154,11 @@ bool Host(std::string portStr, ENetHost *&oServer)
 			}
 			case ENET_EVENT_TYPE_RECEIVE:
 			{
-				if(event.packet->dataLength >= 3 && strncmp((const char*)event.packet->data, "OK1",3)==0)
+				if(net::IsHandshake(event.packet, net::hello))
 				{
 					std::cout << "Received OK1 from "<<event.peer -> address.host<<":"<<event.peer->address.port<<"\n";
 					enet_packet_destroy (event.packet);
-					ENetPacket * packet = enet_packet_create ("OK2", 3, ENET_PACKET_FLAG_RELIABLE);
-					enet_peer_send(event.peer, 1, packet);
+					net::SendHandshake(event.peer, 1, net::welcome);
 					enet_host_service(server,&event,0);
 					return true;
 				}
@@ -193,14 +230,13 @@ bool Join(std::string addressStr, std::string portStr, ENetHost *&oClient)
 	enet_peer_reset (peer);
 	return false;
 success:
-	ENetPacket * packet = enet_packet_create ("OK1", 3, ENET_PACKET_FLAG_RELIABLE);
-	enet_peer_send (peer, 0, packet);
+	net::SendHandshake(peer, 0, net::hello);
 	std::cout <<"I am "<<client->address.host<<"\n";
 	while (enet_host_service (client, &event, 3000) > 0)
 	{
 		if(event.type == ENET_EVENT_TYPE_RECEIVE)
 		{
-			if(event.packet->dataLength >= 3 && strncmp((const char*)event.packet->data, "OK2",3)==0)
+			if(net::IsHandshake(event.packet, net::welcome))
 			{
 				std::cout << "Received OK2\n";
 				enet_packet_destroy (event.packet);
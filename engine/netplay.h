@@ -19,10 +19,19 @@ enum Result{
 	Success,
 	Hosting,
 	Joining,
+	Spectating,
 };
 
+extern int spectatorDelay; //Frames spectators are kept behind the match. Set with -delay when hosting.
+
 Result NetplayArgs(int argc, char** argv, ENetHost *&local, std::string &address);
 
+//Handshake. Whoever joins sends hello and the host answers with welcome.
+constexpr const char *hello = "OK1";
+constexpr const char *welcome = "OK2";
+bool IsHandshake(const ENetPacket *packet, const char *message);
+void SendHandshake(ENetPeer *peer, int channel, const char *message);
+
 };
 
 
@@ -4,7 +4,8 @@
 #include <fstream>
 #include <iostream>
 
-unsigned int keySend[2] {};
+std::atomic<unsigned int> keySend[2] {};
+SpscQueue<InputSample, 1024> inputSamples;
 SDL_Scancode modifiableSCKeys[buttonsN*2];
 JoyInputInfo modifiableJoyKeys[buttonsN*2] = {0};
 std::unordered_map<SDL_JoystickID, int> JoyInstanceIds;
@@ -220,15 +221,30 @@ void EventLoop(std::function<bool(const SDL_KeyboardEvent&)> keyHandler, bool wa
 		return false;
 	};
 
+	//Queue every transition so presses shorter than a frame still reach the simulation.
+	unsigned int before[2] = {keySend[0], keySend[1]};
+	auto queueChanges = [&before]()
+	{
+		InputSample sample{std::chrono::steady_clock::now(), {keySend[0], keySend[1]}};
+		if(sample.keys[0] == before[0] && sample.keys[1] == before[1])
+			return;
+		before[0] = sample.keys[0];
+		before[1] = sample.keys[1];
+		inputSamples.Push(sample); //If it's full the latch still sees the current keys.
+	};
+
 	SDL_Event event;
 	if(wait)
 	{
 		SDL_WaitEvent(&event);
 		handleEvent(event);
+		queueChanges();
 	}
 	else while(SDL_PollEvent(&event))
 	{
-		if(handleEvent(event))
+		bool stop = handleEvent(event);
+		queueChanges();
+		if(stop)
 			break;
 	}
 }
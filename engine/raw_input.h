@@ -1,9 +1,12 @@
 #ifndef RAW_INPUT_H_INCLUDED
 #define RAW_INPUT_H_INCLUDED
 
+#include <atomic>
+#include <chrono>
 #include <functional>
 #include <stdint.h>
 #include <SDL.h>
+#include <spsc_queue.h>
 
 namespace key //Key press as an int after being processed.
 {
@@ -54,8 +57,16 @@ struct JoyInputInfo
 
 constexpr int buttonsN = key::END;
 
+//Both players' keys right after a change, and when the change was seen.
+struct InputSample
+{
+	std::chrono::steady_clock::time_point time;
+	unsigned int keys[2];
+};
+
 extern short deadZone;
-extern unsigned int keySend[2];
+extern std::atomic<unsigned int> keySend[2]; //Written by the event loop, read by the simulation thread.
+extern SpscQueue<InputSample, 1024> inputSamples; //Every change to keySend, in order. Consumed by InputLatch.
 extern SDL_Scancode modifiableSCKeys[buttonsN*2];
 extern JoyInputInfo modifiableJoyKeys[buttonsN*2];
 extern std::unordered_map<SDL_JoystickID, int> JoyInstanceIds;
@@ -0,0 +1,71 @@
+#ifndef RENDER_SNAPSHOT_H_GUARD
+#define RENDER_SNAPSHOT_H_GUARD
+
+#include "actor.h"
+#include "camera.h"
+#include <hitbox_renderer.h>
+#include <particle.h>
+
+#include <chrono>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include <glm/mat4x4.hpp>
+#include <glm/vec2.hpp>
+
+//Everything the render thread needs from one simulated frame. Filled by the simulation thread and read-only once published.
+struct RenderSnapshot
+{
+	using Clock = std::chrono::steady_clock;
+
+	struct Sprite
+	{
+		uint32_t id; //From Actor::GetId. Matches the same actor across snapshots.
+		glm::vec2 pos; //Actor root, the part of the transform that gets interpolated.
+		glm::mat4 transform;
+		int spriteIndex;
+		RenderOptions options;
+	};
+
+	int32_t gameTicks = -1; //-1 until the first snapshot is published.
+	Clock::time_point published;
+
+	std::vector<Sprite> sprites; //In drawing order.
+	int reflections[2]; //Indices of the player sprites.
+
+	glm::mat4 viewMatrix;
+	centerScale center;
+
+	int particleSlice = -1; //Where FillBuffer packed the particles, in GfxHandler's mapped buffer. -1 if there was no free slice.
+	std::vector<ParticleGroup::DrawInfo> particleDraws;
+
+	float health[2];
+	HitboxList boxes; //Empty unless boxes are being drawn.
+};
+
+//What the render thread keeps of a snapshot to interpolate from once the next one arrives.
+struct SnapshotHistory
+{
+	int32_t gameTicks = -1;
+	glm::mat4 viewMatrix;
+	centerScale center;
+	std::unordered_map<uint32_t, glm::vec2> positions;
+
+	void Remember(const RenderSnapshot &snapshot)
+	{
+		gameTicks = snapshot.gameTicks;
+		viewMatrix = snapshot.viewMatrix;
+		center = snapshot.center;
+		positions.clear();
+		for(auto &sprite : snapshot.sprites)
+			positions[sprite.id] = sprite.pos;
+	}
+
+	//Loading a state jumps, and that shouldn't be smoothed over.
+	bool Precedes(const RenderSnapshot &snapshot) const
+	{
+		return gameTicks >= 0 && snapshot.gameTicks == gameTicks + 1;
+	}
+};
+
+#endif /* RENDER_SNAPSHOT_H_GUARD */
@@ -0,0 +1,61 @@
+#include "sound_queue.h"
+#include <algorithm>
+
+SoundQueue::SoundQueue(SoLoud::Soloud &soloud):
+soloud(soloud)
+{}
+
+void SoundQueue::Request(int frame, SoLoud::Wav *wav)
+{
+	requested.push_back({frame, wav});
+}
+
+void SoundQueue::Rollback(int frame)
+{
+	resimulatedFrom = std::min(resimulatedFrom, frame);
+	//Whatever was asked for past this point gets asked for again, or not.
+	std::erase_if(requested, [frame](const SoundEvent &e){return e.frame >= frame;});
+}
+
+void SoundQueue::Dispatch(int gameTime)
+{
+	if(resimulatedFrom != noRollback)
+	{
+		for(auto it = played.begin(); it != played.end();)
+		{
+			if(it->frame < resimulatedFrom)
+			{
+				++it;
+				continue;
+			}
+			auto match = std::find_if(requested.begin(), requested.end(), [&](const SoundEvent &e){
+				return e.frame == it->frame && e.wav == it->wav;
+			});
+			if(match != requested.end()) //Already playing.
+			{
+				requested.erase(match);
+				++it;
+			}
+			else //Mispredicted.
+			{
+				soloud.stop(it->voice);
+				it = played.erase(it);
+			}
+		}
+		resimulatedFrom = noRollback;
+	}
+
+	//Sounds of the same frame are spread out a bit so they don't stack into one loud one.
+	int lastFrame = -1;
+	float offset = 0;
+	for(auto &e : requested)
+	{
+		offset = e.frame == lastFrame ? offset + 0.005f : 0;
+		lastFrame = e.frame;
+		e.voice = soloud.playClocked(e.frame/60.f+offset, *e.wav);
+		played.push_back(e);
+	}
+	requested.clear();
+
+	std::erase_if(played, [gameTime](const SoundEvent &e){return e.frame < gameTime - historyFrames;});
+}
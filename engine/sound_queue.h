@@ -0,0 +1,37 @@
+#ifndef SOUND_QUEUE_H_GUARD
+#define SOUND_QUEUE_H_GUARD
+
+#include <soloud.h>
+#include <soloud_wav.h>
+#include <limits>
+#include <vector>
+
+//Sounds asked for during simulation are queued with their frame and only reach SoLoud in Dispatch.
+//After a rollback, resimulated frames are compared against what was already played:
+//sounds asked for again are skipped and sounds that no longer happen are stopped.
+class SoundQueue
+{
+public:
+	static constexpr int historyFrames = 16; //More than GGPO ever rolls back.
+
+	SoundQueue(SoLoud::Soloud &soloud);
+	void Request(int frame, SoLoud::Wav *wav);
+	void Rollback(int frame); //Call when the state goes back to this frame. Requests from it on are simulated again.
+	void Dispatch(int gameTime); //Plays new sounds and stops mispredicted ones. Call once per simulation step.
+
+private:
+	struct SoundEvent
+	{
+		int frame;
+		SoLoud::Wav *wav;
+		SoLoud::handle voice = 0;
+	};
+	static constexpr int noRollback = std::numeric_limits<int>::max();
+
+	SoLoud::Soloud &soloud;
+	std::vector<SoundEvent> requested; //Since the last Dispatch.
+	std::vector<SoundEvent> played; //Recent enough to be resimulated.
+	int resimulatedFrom = noRollback;
+};
+
+#endif /* SOUND_QUEUE_H_GUARD */
@@ -0,0 +1,163 @@
+#include "spectator.h"
+#include "netplay.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+SpectatorServer::SpectatorServer(unsigned short port, int delay):
+delay(delay)
+{
+	ENetAddress address;
+	address.host = ENET_HOST_ANY;
+	address.port = port;
+	host = enet_host_create(&address, maxSpectators, 2, 0, 0);
+	if(!host)
+		std::cerr << "Can't listen for spectators at port " << port << "\n";
+	else
+		std::cout << "Spectators can join at port " << port << ", " << delay << " frames behind.\n";
+}
+
+SpectatorServer::~SpectatorServer()
+{
+	if(!host)
+		return;
+	//Whoever didn't leave in Finish gets dropped. Queued inputs are lost.
+	for(auto &target : spectators)
+		enet_peer_disconnect_now(target.peer, 0);
+	enet_host_destroy(host);
+}
+
+void SpectatorServer::Update(const InputBuffer inputs[2], int confirmedFrames)
+{
+	if(!host)
+		return;
+
+	ENetEvent event;
+	while(enet_host_service(host, &event, 0) > 0)
+	{
+		switch(event.type)
+		{
+		case ENET_EVENT_TYPE_RECEIVE:
+			//Same channel as the inputs so the answer gets there first.
+			if(net::IsHandshake(event.packet, net::hello))
+			{
+				net::SendHandshake(event.peer, 0, net::welcome);
+				spectators.push_back({event.peer});
+				std::cout << "Spectator " << spectators.size() << " joined from " <<
+					event.peer->address.host << ":" << event.peer->address.port << "\n";
+			}
+			enet_packet_destroy(event.packet);
+			break;
+		case ENET_EVENT_TYPE_DISCONNECT:
+			std::erase_if(spectators, [peer = event.peer](const Spectator &s){return s.peer == peer;});
+			break;
+		default:
+			break;
+		}
+	}
+
+	//Confirmed frames never roll back, so nothing sent has to be corrected later.
+	int available = std::min(confirmedFrames - delay, (int)inputs[0].buffer.size());
+	for(auto &target : spectators)
+	{
+		while(available - target.sent >= batchFrames)
+			Send(target, inputs, std::min(available - target.sent, maxPacketFrames));
+	}
+	enet_host_flush(host);
+}
+
+void SpectatorServer::Finish(const InputBuffer inputs[2], int confirmedFrames)
+{
+	if(!host)
+		return;
+	int available = std::min(confirmedFrames, (int)inputs[0].buffer.size());
+	for(auto &target : spectators)
+	{
+		while(available > target.sent)
+			Send(target, inputs, std::min(available - target.sent, maxPacketFrames));
+		enet_peer_disconnect_later(target.peer, 0);
+	}
+
+	//The peers disconnect once they've acknowledged everything queued before.
+	//Destroying the host earlier would drop whatever is still in flight.
+	auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(finishTimeout);
+	ENetEvent event;
+	while(!spectators.empty() && std::chrono::steady_clock::now() < deadline)
+	{
+		if(enet_host_service(host, &event, 50) <= 0)
+			continue;
+		if(event.type == ENET_EVENT_TYPE_RECEIVE)
+			enet_packet_destroy(event.packet);
+		else if(event.type == ENET_EVENT_TYPE_DISCONNECT)
+			std::erase_if(spectators, [peer = event.peer](const Spectator &s){return s.peer == peer;});
+	}
+	if(!spectators.empty())
+		std::cerr << spectators.size() << " spectators didn't get the end of the match in time.\n";
+}
+
+void SpectatorServer::Send(Spectator &target, const InputBuffer inputs[2], int count)
+{
+	spectator::PacketHeader header{(uint32_t)target.sent, (uint32_t)count};
+	packetData.resize(sizeof(header));
+	memcpy(packetData.data(), &header, sizeof(header));
+	for(int i = 0; i < 2; ++i)
+	{
+		auto &buffer = inputs[i].buffer;
+		uint32_t previous = target.sent > 0 ? buffer[target.sent-1] : 0;
+		spectator::Encode(buffer.data() + target.sent, count, previous, packetData);
+	}
+
+	ENetPacket *packet = enet_packet_create(packetData.data(), packetData.size(), ENET_PACKET_FLAG_RELIABLE);
+	enet_peer_send(target.peer, 0, packet);
+	target.sent += count;
+}
+
+SpectatorClient::SpectatorClient(ENetHost *host):
+host(host)
+{}
+
+bool SpectatorClient::Receive(InputBuffer inputs[2])
+{
+	ENetEvent event;
+	while(enet_host_service(host, &event, 0) > 0)
+	{
+		switch(event.type)
+		{
+		case ENET_EVENT_TYPE_RECEIVE:
+		{
+			spectator::PacketHeader header;
+			const uint8_t *data = event.packet->data;
+			const uint8_t *end = data + event.packet->dataLength;
+			bool valid = event.packet->dataLength >= sizeof(header);
+			if(valid)
+			{
+				memcpy(&header, data, sizeof(header));
+				data += sizeof(header);
+				//Packets come in order, so anything else means the stream is broken.
+				valid = header.firstFrame == inputs[0].buffer.size();
+			}
+			for(int i = 0; i < 2 && valid; ++i)
+			{
+				auto &buffer = inputs[i].buffer;
+				uint32_t previous = buffer.empty() ? 0 : buffer.back();
+				valid = spectator::Decode(data, end, header.frameCount, previous, buffer);
+			}
+			enet_packet_destroy(event.packet);
+			if(!valid)
+			{
+				std::cerr << "Bad spectator packet.\n";
+				enet_peer_disconnect(&host->peers[0], 0);
+				return false;
+			}
+			break;
+		}
+		case ENET_EVENT_TYPE_DISCONNECT:
+			std::cout << "The match host is gone.\n";
+			return false;
+		default:
+			break;
+		}
+	}
+	return true;
+}
@@ -0,0 +1,58 @@
+#ifndef SPECTATOR_H_GUARD
+#define SPECTATOR_H_GUARD
+
+#include "command_inputs.h"
+#include "spectator_codec.h"
+#include <vector>
+#include <enet/enet.h>
+
+//Streams the match inputs to spectators on its own port, a fixed delay behind the match.
+//Spectators join with the same handshake as netplay. Simulation thread only.
+class SpectatorServer
+{
+public:
+	static constexpr int maxSpectators = 64;
+	static constexpr int batchFrames = 8; //Frames per packet once a spectator is caught up.
+	static constexpr int maxPacketFrames = 600; //For spectators that joined late.
+	static constexpr int finishTimeout = 3000; //Milliseconds Finish waits for spectators to leave.
+
+	SpectatorServer(unsigned short port, int delay);
+	~SpectatorServer();
+	SpectatorServer(const SpectatorServer&) = delete;
+	SpectatorServer& operator=(const SpectatorServer&) = delete;
+	explicit operator bool() const { return host; }
+
+	//Accepts spectators and sends each one the frames it's missing, up to confirmedFrames - delay.
+	void Update(const InputBuffer inputs[2], int confirmedFrames);
+	//Sends everything up to confirmedFrames, delay included. For when the match is over.
+	//Predicted frames past that could still be rolled back, so spectators never get them.
+	//Blocks until every spectator has received it all and disconnected, or finishTimeout passes.
+	void Finish(const InputBuffer inputs[2], int confirmedFrames);
+
+private:
+	struct Spectator
+	{
+		ENetPeer *peer;
+		int sent = 0; //Frames sent so far.
+	};
+
+	ENetHost *host = nullptr;
+	int delay;
+	std::vector<Spectator> spectators;
+	std::vector<uint8_t> packetData;
+
+	void Send(Spectator &target, const InputBuffer inputs[2], int count);
+};
+
+//Appends the frames sent by a SpectatorServer to the input buffers. The host comes from Join.
+class SpectatorClient
+{
+public:
+	SpectatorClient(ENetHost *host);
+	bool Receive(InputBuffer inputs[2]); //Returns false once the server is gone.
+
+private:
+	ENetHost *host;
+};
+
+#endif /* SPECTATOR_H_GUARD */
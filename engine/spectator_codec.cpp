@@ -0,0 +1,71 @@
+#include "spectator_codec.h"
+
+namespace spectator
+{
+
+static void WriteVarint(uint32_t value, std::vector<uint8_t> &out)
+{
+	while(value >= 0x80)
+	{
+		out.push_back(value | 0x80);
+		value >>= 7;
+	}
+	out.push_back(value);
+}
+
+static bool ReadVarint(const uint8_t *&data, const uint8_t *end, uint32_t &value)
+{
+	value = 0;
+	for(int shift = 0; shift < 35 && data < end; shift += 7)
+	{
+		uint8_t byte = *data++;
+		value |= (uint32_t)(byte & 0x7F) << shift;
+		if(!(byte & 0x80))
+			return true;
+	}
+	return false;
+}
+
+void Encode(const uint32_t *inputs, size_t count, uint32_t previous, std::vector<uint8_t> &out)
+{
+	uint32_t run = 0;
+	for(size_t i = 0; i < count; ++i)
+	{
+		uint32_t change = inputs[i] ^ previous;
+		previous = inputs[i];
+		if(change == 0)
+		{
+			++run;
+			continue;
+		}
+		WriteVarint(run, out);
+		WriteVarint(change, out);
+		run = 0;
+	}
+	if(run > 0) //The change is never applied because the count runs out first.
+	{
+		WriteVarint(run, out);
+		WriteVarint(0, out);
+	}
+}
+
+bool Decode(const uint8_t *&data, const uint8_t *end, size_t count, uint32_t previous, std::vector<uint32_t> &out)
+{
+	while(count > 0)
+	{
+		uint32_t run, change;
+		if(!ReadVarint(data, end, run) || !ReadVarint(data, end, change) || run > count)
+			return false;
+		out.insert(out.end(), run, previous);
+		count -= run;
+		if(count > 0)
+		{
+			previous ^= change;
+			out.push_back(previous);
+			--count;
+		}
+	}
+	return true;
+}
+
+}
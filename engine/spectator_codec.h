@@ -0,0 +1,24 @@
+#ifndef SPECTATOR_CODEC_H_GUARD
+#define SPECTATOR_CODEC_H_GUARD
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace spectator
+{
+	//Each packet has this, then the inputs of each player for those frames.
+	struct PacketHeader
+	{
+		uint32_t firstFrame;
+		uint32_t frameCount;
+	};
+
+	//Inputs are XORed with the one of the previous frame, then stored as varint pairs of
+	//(unchanged frames, change). Held buttons and neutral stretches cost two bytes.
+	void Encode(const uint32_t *inputs, size_t count, uint32_t previous, std::vector<uint8_t> &out);
+	//Appends count inputs to out. Returns false if the data ends early. Moves data past what it read.
+	bool Decode(const uint8_t *&data, const uint8_t *end, size_t count, uint32_t previous, std::vector<uint32_t> &out);
+}
+
+#endif /* SPECTATOR_CODEC_H_GUARD */
@@ -1,11 +1,14 @@
 #include "stage.h"
 #include "window.h"
+#include <script_file.h>
+#include <trace.h>
 #include <iostream>
 #include <glm/ext/matrix_transform.hpp>
 
 Stage::Stage(GfxHandler &gfx, std::filesystem::path file):
 gfx(&gfx)
 {
+	TRACE_ZONE("Stage");
 	sol::state lua;
 	//Blending
 	lua["additive"] = additive;
@@ -14,7 +17,7 @@ gfx(&gfx)
 	lua["horizontal"] = horizontal;
 	lua["vertical"] = vertical;
 	GfxHandler::LoadLuaDefinitions(lua);
-	auto result = lua.script_file(file.string());
+	auto result = ScriptFile(lua, file);
 	if(!result.valid()){
 		sol::error err = result;
 		std::cerr << "When loading " << file <<"\n";
@@ -0,0 +1,42 @@
+#include "string_intern.h"
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+
+namespace intern
+{
+
+//Deque so references returned by String() stay valid while new strings get added.
+static std::deque<std::string> strings;
+static std::unordered_map<std::string, int> ids;
+static std::mutex mutex;
+
+int Get(const std::string &str)
+{
+	std::lock_guard lock(mutex);
+	auto search = ids.find(str);
+	if(search != ids.end())
+		return search->second;
+
+	int id = strings.size();
+	strings.push_back(str);
+	ids.insert({str, id});
+	return id;
+}
+
+int Find(const std::string &str)
+{
+	std::lock_guard lock(mutex);
+	auto search = ids.find(str);
+	if(search != ids.end())
+		return search->second;
+	return none;
+}
+
+const std::string &String(int id)
+{
+	std::lock_guard lock(mutex);
+	return strings[id];
+}
+
+}
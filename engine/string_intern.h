@@ -0,0 +1,17 @@
+#ifndef STRING_INTERN_H_GUARD
+#define STRING_INTERN_H_GUARD
+
+#include <string>
+
+//Maps strings to small integer ids so state that gets copied every frame doesn't own any strings.
+//Ids are global and never invalidated.
+namespace intern
+{
+	constexpr int none = -1;
+
+	int Get(const std::string &str); //Interns the string if it's not there yet.
+	int Find(const std::string &str); //Returns none if the string was never interned.
+	const std::string &String(int id);
+}
+
+#endif /* STRING_INTERN_H_GUARD */
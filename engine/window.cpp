@@ -3,15 +3,6 @@
 
 #include <iostream>
 
-//#define GENERIC_SLEEP
-#if defined (_WIN32) && !defined(GENERIC_SLEEP)
-	#include <windows.h>
-	#include <timeapi.h>
-#else
-	#include <thread>
-	#include <chrono>
-#endif
-
 Window *mainWindow = nullptr;
 
 Window::Window(bool vsync) :
@@ -46,6 +37,8 @@ realSpf(0)
 	}
 
 	renderer.Init(window, vsync);
+	targetSpf = GetDisplaySpf();
+	pacer.SetPeriod(targetSpf);
 }
 
 Window::~Window()
@@ -62,67 +55,11 @@ void Window::ShowWindow(bool show)
 		SDL_HideWindow(window);
 }
 
-#if defined (_WIN32) && !defined(GENERIC_SLEEP)
-UINT GetMinTimer(){
-	TIMECAPS tc;
-	timeGetDevCaps(&tc, sizeof(tc));
-	return tc.wPeriodMin;
-};
-LONGLONG GetFreq(){
-	LARGE_INTEGER freq;
-	QueryPerformanceFrequency(&freq);
-	return freq.QuadPart;
-}
-auto frequency = GetFreq();
-UINT minTimer = GetMinTimer(); 
-LARGE_INTEGER startClockHr{};
-void Window::SleepUntilNextFrame()
+void Window::SleepUntilNextFrame(const std::function<void()> &poll)
 {
-	timeBeginPeriod(minTimer);
-	ULONGLONG targetCount = frequency*(targetSpf);
-	ULONGLONG dif; 
-
-	LARGE_INTEGER nowTicks;
-	QueryPerformanceCounter(&nowTicks);
-	if((dif = nowTicks.QuadPart - startClockHr.QuadPart) < targetCount)
-	{
-		LONG sleepTime = ((targetCount-dif)/(frequency/1000))-1;
-		if(sleepTime>0)
-			Sleep(sleepTime);
-	}
-
-	while((dif = nowTicks.QuadPart - startClockHr.QuadPart) < targetCount)
-		QueryPerformanceCounter(&nowTicks); 
-
-	realSpf = (double)dif/(double)frequency;
-	QueryPerformanceCounter(&startClockHr);
-	timeEndPeriod(minTimer);
+	pacer.Wait(uncapped, poll);
+	realSpf = pacer.Interval();
 }
-#else
-std::chrono::time_point<std::chrono::high_resolution_clock> startClock(std::chrono::high_resolution_clock::now()); 
-void Window::SleepUntilNextFrame()
-{
-	constexpr double factor = 0.9; 
-	if(!uncapped)
-	{
-		std::chrono::duration<double> targetDur(targetSpf);
-		std::chrono::duration<double> dur; 
-		auto now = std::chrono::high_resolution_clock::now();
-		if((dur = now - startClock) < targetDur)
-		{
-			std::this_thread::sleep_for((targetDur-dur)*factor);
-		}
-		while( (dur = std::chrono::high_resolution_clock::now() - startClock) <= targetDur); 
-	
-		realSpf = dur.count();
-	}
-	else
-	{
-		realSpf = std::chrono::duration<double>(std::chrono::high_resolution_clock::now()-startClock).count();
-	}
-	startClock = std::chrono::high_resolution_clock::now();
-}
-#endif
 
 void Window::SwapBuffers()
 {
@@ -134,10 +71,19 @@ double Window::GetSpf()
 	return realSpf;
 }
 
+double Window::GetDisplaySpf()
+{
+	SDL_DisplayMode mode;
+	int display = SDL_GetWindowDisplayIndex(window);
+	if(display < 0 || SDL_GetCurrentDisplayMode(display, &mode) || mode.refresh_rate <= 0)
+		return 1.0/60.0;
+	return 1.0/mode.refresh_rate;
+}
+
 void Window::ChangeFramerate()
 {
-	constexpr double framerateList[4] = {
-		0.01666, 
+	const double framerateList[4] = {
+		GetDisplaySpf(),
 		1.0/30.0, 
 		1.0/10.0,
 		1.0/2.0
@@ -147,6 +93,7 @@ void Window::ChangeFramerate()
 	if(frameRateChoice >= 4)
 		frameRateChoice = 0;
 	targetSpf = framerateList[frameRateChoice];
+	pacer.SetPeriod(targetSpf);
 }
 
 
@@ -1,14 +1,17 @@
 #ifndef WINDOW_H_INCLUDED
 #define WINDOW_H_INCLUDED
 
+#include <atomic>
+#include <functional>
 #include <memory>
 #include <SDL.h>
 #include "vk/renderer.h"
+#include "frame_pacer.h"
 
 class Window
 {
 public:
-	bool wantsToClose;
+	std::atomic<bool> wantsToClose; //Set from the simulation thread too.
 	
 private:
 	bool fullscreen;
@@ -18,6 +21,7 @@ private:
 	int frameRateChoice;
 	double targetSpf;
 	double realSpf;
+	FramePacer pacer;
 
 public:
 	Renderer renderer;
@@ -30,11 +34,13 @@ public:
 	void ChangeFramerate();
 	bool HandleEvents(SDL_Event event);
 
-	//Sleeps until it's time to process the next frame.
-	void SleepUntilNextFrame();
+	//Sleeps until it's time to process the next frame. Calls poll about every millisecond meanwhile.
+	void SleepUntilNextFrame(const std::function<void()> &poll = nullptr);
 
 	double GetSpf();
-	
+	double GetDisplaySpf(); //Refresh period of the display the window is on.
+	const FramePacer &GetPacer() const { return pacer; }
+
 };
 
 extern Window *mainWindow;
@@ -1,4 +1,6 @@
 #include "framedata_io.h"
+#include "trace.h"
+#include <vfs.h>
 //#include "render.h"
 
 #include <fstream>
@@ -92,28 +94,32 @@ struct Context{
 
 bool Framedata::LoadFD(std::filesystem::path path)
 {
+	TRACE_ZONE_DETAIL("Framedata::LoadFD", path.generic_string());
 	using namespace bitsery;
-	std::ifstream file(path, std::ifstream::in | std::ifstream::binary);
-
-	if (!file.is_open())
+	auto file = vfs::Open(path);
+	if (!file)
 		return false;
 
 	//Read header
 	Header header;
-	Deserializer<InputStreamAdapter> desFile{file};
+	Deserializer<InputBufferAdapter<const char*>> desFile{(const char*)file.Data(), file.Size()};
 	auto &adapter = desFile.adapter();
 	desFile.object(header);
 	
-	if(adapter.error() == ReaderError::NoError 
-		&& strncmp(header.signature, CurrentHeader.signature, sizeof(Header::signature)) != 0)
+	if(adapter.error() != ReaderError::NoError 
+		|| strncmp(header.signature, CurrentHeader.signature, sizeof(Header::signature)) != 0)
 		return false;
 
-	//Decompress
-	std::vector<char> compressedBuf(header.fileSizeCompressed);
-	desFile.container1b(compressedBuf, 0x4000000);
+	//Decompress straight from the mapping. This is the length prefix container1b wrote.
+	size_t compressedSize;
+	details::readSize(adapter, compressedSize, 0x4000000, std::true_type{});
+	size_t start = adapter.currentReadPos();
+	if(adapter.error() != ReaderError::NoError || compressedSize != header.fileSizeCompressed
+		|| start + compressedSize != file.Size())
+		return false;
 
 	std::vector<char> data(header.fileSize);
-	auto bufSize = LZ4_decompress_safe(compressedBuf.data(), data.data(), header.fileSizeCompressed, header.fileSize);
+	auto bufSize = LZ4_decompress_safe((const char*)file.Data() + start, data.data(), compressedSize, header.fileSize);
 	if(bufSize < 0 || bufSize != header.fileSize)
 		return false;
 
@@ -122,7 +128,7 @@ bool Framedata::LoadFD(std::filesystem::path path)
 	Deserializer<decltype(inputAdapter), Context> desBuf{context, std::move(inputAdapter)};
 	desBuf.container(sequences, 0xFFFF);
 
-	bool success = adapter.error() == ReaderError::NoError && adapter.isCompletedSuccessfully();
+	bool success = desBuf.adapter().error() == ReaderError::NoError && desBuf.adapter().isCompletedSuccessfully();
 	loaded = success;
 	return success;
 }
@@ -1,8 +1,11 @@
 #include "gfx_handler.h"
-#include "image.h"
+#include "texture_streamer.h"
+#include "script_file.h"
+#include "trace.h"
+#include <algorithm>
 #include <iostream>
 #include <sol/sol.hpp>
-#include <fstream>
+#include <cstring>
 #include <glm/mat4x4.hpp>
 
 constexpr unsigned int vertexStride = 4 * sizeof(short);
@@ -24,10 +27,11 @@ void GfxHandler::LoadLuaDefinitions(sol::state &lua)
 
 int GfxHandler::LoadGfxFromDef(std::filesystem::path defFile)
 {
+	TRACE_ZONE_DETAIL("GfxHandler::LoadGfxFromDef", defFile.generic_string());
 	auto folder = defFile.parent_path();
 	sol::state lua;
 	LoadLuaDefinitions(lua);
-	auto result = lua.script_file(defFile.string());
+	auto result = ScriptFile(lua, defFile);
 	if(!result.valid()){
 		sol::error err = result;
 		std::cerr << "When loading " << defFile <<"\n";
@@ -44,8 +48,9 @@ int GfxHandler::LoadGfxFromLua(sol::state &lua, std::filesystem::path workingDir
 	int mapId = idMapList.size();
 	idMapList.push_back({});
 
+	//Everything is decoded at once in the background. The decoded header says what kind of texture it is.
 	std::vector<Renderer::LoadTextureInfo> infos;
-	
+	std::vector<std::filesystem::path> vertexFiles;
 	for(const auto &entry : graphics)
 	{
 		sol::table arr = entry.second;
@@ -54,55 +59,68 @@ int GfxHandler::LoadGfxFromLua(sol::state &lua, std::filesystem::path workingDir
 		sol::optional<std::string> vertexFile = arr["vertex"];
 		if(imageFile && vertexFile)
 		{
-			int type = arr["type"].get_or(0);
-			Renderer::LoadTextureInfo info{
+			infos.push_back({
 				.path = workingDir/imageFile.value(),
 				.type = Renderer::SrcTextureType::standard
-			};
-
-			int ByPP = ImageData::PeekBytesPerPixel(info.path);
-			if(ByPP == 1)
-			{
-				LoadToVertexBuffer(workingDir/vertexFile.value(), mapId, index8);
-				index8++;
-			}
-			else if(ByPP == 4) //32bit textures have negative indices to differenciate.
-			{
-				LoadToVertexBuffer(workingDir/vertexFile.value(), mapId, index32-1);
-				index32--;
-			}
-			else
-			{
-				std::cerr << info.path << " : Unhandled texture byte depth "<<ByPP<<". Skipping...";
-				continue;
-			}
-			infos.push_back(std::move(info));
+			});
+			vertexFiles.push_back(workingDir/vertexFile.value());
 		}
 	}
 
-	int spriteEndIndexNeg = -infos.size();
+	size_t spriteTextures = infos.size();
 	sol::optional<std::vector<std::string>> imageListOpt = graphics["images"];
 	if(imageListOpt)
 	{
 		for(const std::string &imageFile : imageListOpt.value())
 		{
-			auto path = workingDir/imageFile;
 			infos.push_back({
-				.path = path,
+				.path = workingDir/imageFile,
 				.type = Renderer::SrcTextureType::standard
 			});
-			int ByPP = ImageData::PeekBytesPerPixel(path);
-			assert(ByPP == 4 && "Unsupported ByPP");
 		}
 	}
 
-	spriteEndIndexNeg += infos.size();
+	std::vector<Renderer::Texture> textures;
+	{
+		TRACE_ZONE("Wait for textures");
+		auto load = renderer.LoadTexturesAsync(infos);
+		renderer.WaitTextures(*load);
+		textures = load->Take();
+	}
 
-	renderer.LoadTextures(infos, textureAtlas);
+	//Kept in def file order, so sprite indices don't depend on which image finished first.
+	for(size_t i = 0; i < spriteTextures; ++i)
+	{
+		auto &texture = textures[i];
+		if(!texture.buf.allocator) //Failed to decode.
+		{
+			std::cerr << infos[i].path << " : Can't be decoded. Skipping...";
+			continue;
+		}
+
+		if(texture.format == vk::Format::eR8Uint)
+		{
+			LoadToVertexBuffer(vertexFiles[i], mapId, index8);
+			index8++;
+		}
+		else //32bit textures have negative indices to differenciate.
+		{
+			LoadToVertexBuffer(vertexFiles[i], mapId, index32-1);
+			index32--;
+		}
+		textureAtlas.push_back(std::move(texture));
+	}
 
 	//Keep chunked textures separate.
-	textureQuads.insert(textureQuads.end(), std::make_move_iterator(textureAtlas.end() - spriteEndIndexNeg), std::make_move_iterator(textureAtlas.end()));
-	textureAtlas.erase(textureAtlas.end() - spriteEndIndexNeg, textureAtlas.end());
+	for(size_t i = spriteTextures; i < textures.size(); ++i)
+	{
+		if(textures[i].format != vk::Format::eR8G8B8A8Srgb && textures[i].format != vk::Format::eBc3SrgbBlock)
+		{
+			std::cerr << infos[i].path << " : Only 32bit images can be used here.\n";
+			throw std::runtime_error("Unsupported image format.");
+		}
+		textureQuads.push_back(std::move(textures[i]));
+	}
 
 	//If there's a palette add it.
 	auto palettesOptFp = lua.get<sol::optional<std::string>>("palettes");
@@ -110,17 +128,20 @@ int GfxHandler::LoadGfxFromLua(sol::state &lua, std::filesystem::path workingDir
 	{
 		auto start = paletteData.size();
 		std::filesystem::path filepath = workingDir/palettesOptFp.value();
-		std::basic_ifstream<uint8_t> paletteFile(filepath, std::ios_base::binary);
-		if(paletteFile.is_open())
+		auto paletteFile = vfs::Open(filepath);
+		if(paletteFile)
 		{
 			uint32_t size = -1;
-			paletteFile.read((uint8_t*)&size, sizeof(size));
+			if(paletteFile.Size() >= sizeof(size))
+				memcpy(&size, paletteFile.Data(), sizeof(size));
 			if(size > 64)
 				throw std::runtime_error("Palette entries exceed 64");
 
 			size = 4*256*size;
+			if(sizeof(uint32_t) + size > paletteFile.Size())
+				throw std::runtime_error(filepath.string()+" : file is truncated.\n");
 			paletteData.resize(start+size);
-			paletteFile.read(&paletteData[start], sizeof(uint8_t)*size);
+			memcpy(&paletteData[start], paletteFile.Data() + sizeof(uint32_t), size);
 		}
 		else
 			throw std::runtime_error(std::string("Can't open palette file ")+filepath.string());
@@ -130,42 +151,67 @@ int GfxHandler::LoadGfxFromLua(sol::state &lua, std::filesystem::path workingDir
 
 void GfxHandler::LoadToVertexBuffer(std::filesystem::path file, int mapId, int textureIndex)
 {
-	int nSprites, nChunks;
-	std::ifstream vertexFile(file, std::ios_base::binary);
-	if(!vertexFile.is_open())
+	TRACE_ZONE_DETAIL("Vertex file", file.generic_string());
+	auto mapped = vfs::Open(file);
+	if(!mapped)
 		throw std::runtime_error(file.string()+" : path doesn't exist.\n");
 
-	vertexFile.read((char *)&nSprites, sizeof(int));
-	auto chunksPerSprite = new uint16_t[nSprites];
-	vertexFile.read((char *)chunksPerSprite, sizeof(uint16_t)*nSprites);
-
-	vertexFile.read((char *)&nChunks, sizeof(int));
+	const uint8_t *data = mapped.Data();
+	size_t pos = 0;
+	auto read = [&](void *dst, size_t size){
+		if(pos + size > mapped.Size())
+			throw std::runtime_error(file.string()+" : file is truncated.\n");
+		memcpy(dst, data+pos, size);
+		pos += size;
+	};
 
-	int vdStart = tempVDContainer.size();
-	//tempVDContainer.push_back(std::make_unique<VertexData4[]>(nChunks*6));
-	tempVDContainer.emplace_back(new VertexData4[nChunks*6]);
-	int size = sizeof(VertexData4);
+	int nSprites, nChunks;
+	read(&nSprites, sizeof(int));
+	std::vector<uint16_t> chunksPerSprite(nSprites);
+	read(chunksPerSprite.data(), sizeof(uint16_t)*nSprites);
+	read(&nChunks, sizeof(int));
+
+	//Left in the mapping. VertexBuffer::Load copies it to the staging buffer.
+	size_t size = sizeof(VertexData4);
+	size_t vertexStart = pos;
+	if(pos + nChunks*6*size > mapped.Size())
+		throw std::runtime_error(file.string()+" : file is truncated.\n");
+	pos += nChunks*6*size;
 
-	vertexFile.read((char *)(tempVDContainer[vdStart].get()), nChunks*6*size);
 	int chunkCount = 0;
 	for(int i = 0; i < nSprites; i++)
 	{
 		uint16_t virtualId;
-		vertexFile.read((char*)&virtualId, sizeof(virtualId));
+		read(&virtualId, sizeof(virtualId));
 
-		int trueId = vertices.Prepare(size*6*((int)chunksPerSprite[i]), vertexStride, tempVDContainer[vdStart].get()+6*chunkCount);
+		int trueId = vertices.Prepare(size*6*((int)chunksPerSprite[i]), vertexStride, (void*)(data+vertexStart+size*6*chunkCount));
 		chunkCount += chunksPerSprite[i];
 
-		idMapList[mapId].insert({virtualId, {trueId, textureIndex}});
+		auto &idMap = idMapList[mapId];
+		if(virtualId >= idMap.size())
+			idMap.resize(virtualId+1);
+		idMap[virtualId].trueId = trueId;
+		idMap[virtualId].textureIndex = textureIndex;
 	}
 	
-	delete[] chunksPerSprite;
+	vertexFiles.push_back(std::move(mapped));
 }
 
 void GfxHandler::LoadingDone()
 {
-	vertices.Load();
-	tempVDContainer.clear();
+	TRACE_ZONE("GfxHandler::LoadingDone");
+	vertices.Load(vk::BufferUsageFlagBits::eStorageBuffer); //Pulled by sprite.vert.
+	vertexFiles.clear();
+	for(auto &idMap : idMapList)
+	{
+		for(auto &meta : idMap)
+		{
+			if(meta.trueId < 0)
+				continue;
+			auto range = vertices.Index(meta.trueId);
+			meta.mesh = {(uint32_t)range.first, (uint32_t)range.second};
+		}
+	}
 	SetupSpritePipeline();
 	SetupParticlePipeline();
 	
@@ -200,19 +246,31 @@ void GfxHandler::SetupSpritePipeline()
 	auto pBuilder = renderer.GetPipelineBuilder();
 	pBuilder
 		.SetSpecializationConstants({iTextureNumber, textureNumber})
+		.HintDescriptorType(1, 0, vk::DescriptorType::eStorageBufferDynamic)
 		.SetShaders("data/spirv/sprite.vert.bin", "data/spirv/sprite.frag.bin")
-		.SetInputLayout(true, {vk::Format::eR16G16Sint, vk::Format::eR16G16Sint})
-		.SetPushConstants({
-			{.stageFlags = vk::ShaderStageFlagBits::eVertex | vk::ShaderStageFlagBits::eFragment, .size = sizeof(pcSprites)},
-		})
 	;
 	spritePipe.pipeline = pBuilder.Build(spritePipe.pipeset);
+
+	size_t instancesSize = maxSprites * sizeof(SpriteInstance);
+	spriteInstances.Allocate(&renderer, instancesSize,
+	vk::BufferUsageFlagBits::eStorageBuffer, vma::MemoryUsage::eCpuToGpu, renderer.bufferedFrames);
+	spriteInstances.Map();
 /* 	pBuilder.colorBlendAttachment.srcColorBlendFactor = vk::BlendFactor::eOne;
 	pBuilder.colorBlendAttachment.dstColorBlendFactor = vk::BlendFactor::eOne;
 	pBuilder.BuildDerivate(spriteAdditive); */
 
 	std::vector<PipelineBuilder::WriteSetInfo> updateSetParams;
-	updateSetParams.reserve(textureAtlas.size()+1);
+	updateSetParams.reserve(textureAtlas.size()+3);
+	updateSetParams.push_back({vk::DescriptorBufferInfo{ //Sprite instances, offset by frame.
+		.buffer = spriteInstances.buffer,
+		.offset = 0,
+		.range = instancesSize,
+	}, 1, 0});
+	updateSetParams.push_back({vk::DescriptorBufferInfo{ //Vertices, pulled by instance.
+		.buffer = vertices.buffer.buffer,
+		.offset = 0,
+		.range = VK_WHOLE_SIZE,
+	}, 1, 1});
 	updateSetParams.push_back({vk::DescriptorImageInfo{ //Palette
 		.sampler = *sampler,
 		.imageView = *palette.view,
@@ -238,80 +296,107 @@ void GfxHandler::SetupSpritePipeline()
 	pBuilder.UpdateSets(updateSetParams);
 }
 
-bool GfxHandler::Begin()
+bool GfxHandler::Begin(int layer)
 {
-	cmd = renderer.GetCommand();
+	cmd = renderer.GetCommand(layer);
 	if(!cmd)
 		return false;
 
-	void *propMem = particleProperties.Map();
+	//Acquire waited for this frame's fence, so the GPU is done with what it read the last time.
+	uint32_t frameBit = 1 << renderer.CurrentFrame();
+	for(int slice = 0; slice < particleSlices; ++slice)
+	{
+		if(!(sliceFrames[slice] & frameBit))
+			continue;
+		sliceFrames[slice] &= ~frameBit;
+		if(sliceReleased[slice] && !sliceFrames[slice])
+		{
+			sliceReleased[slice] = false;
+			freeParticleSlices.Push(slice);
+		}
+	}
 
-	cmd->bindPipeline(vk::PipelineBindPoint::eGraphics, *spritePipe.pipeline);
-	cmd->bindVertexBuffers(0, vertices.buffer.buffer, {0});
-	cmd->bindDescriptorSets(vk::PipelineBindPoint::eGraphics, *spritePipe.pipeset.layout, 0, {
-		spritePipe.pipeset.Get(0,0)
-	}, nullptr);
-	//boundPipe = normal;
+	spritesUsed = 0;
 	return true;
 }
 
 void GfxHandler::Draw(int id, int defId)
 {
-	auto search = idMapList[defId].find(id);
-	if (search != idMapList[defId].end())
+	const auto &idMap = idMapList[defId];
+	if(id < 0 || id >= idMap.size() || idMap[id].trueId < 0)
+		return;
+
+	const auto &meta = idMap[id];
+	if(meta.textureIndex >= 0)
 	{
-		auto meta = search->second;
-		if(meta.textureIndex >= 0)
-		{
-			pcSprites.shaderType = 0;
-			pcSprites.textureIndex = meta.textureIndex;
-		}
-		else
-		{
-			pcSprites.shaderType = 1;
-			pcSprites.textureIndex = -meta.textureIndex-1;
-		}
+		currentSprite.shaderType = 0;
+		currentSprite.textureIndex = meta.textureIndex;
+	}
+	else
+	{
+		currentSprite.shaderType = 1;
+		currentSprite.textureIndex = -meta.textureIndex-1;
+	}
 
-		pcSprites.mulColor = mulColor;
-		pcSprites.mulColor.a *= blendingModeFactor;
-		
-		cmd->pushConstants(*spritePipe.pipeset.layout, vk::ShaderStageFlagBits::eFragment |  vk::ShaderStageFlagBits::eVertex,
-			0, sizeof(pcSprites), &pcSprites);
+	currentSprite.mulColor = mulColor;
+	currentSprite.mulColor.a *= blendingModeFactor;
+	spriteBatch.Add(meta.mesh, currentSprite);
+}
 
-		auto what = vertices.Index(meta.trueId);
-		cmd->draw(what.second, 1, what.first, 0);
-	} 
+void GfxHandler::Flush()
+{
+	if(spriteBatch.Empty())
+		return;
+
+	auto frame = renderer.CurrentFrame();
+	auto buf = (SpriteInstance*)spriteInstances.Map(frame);
+	size_t first = spritesUsed;
+	if(spriteBatch.Size() > maxSprites - first)
+		std::cerr << "Too many sprites this frame. Only " << maxSprites << " can be drawn.\n";
+	auto &batches = spriteBatch.Build(buf + first, maxSprites - first);
+
+	cmd->bindPipeline(vk::PipelineBindPoint::eGraphics, *spritePipe.pipeline);
+	cmd->bindDescriptorSets(vk::PipelineBindPoint::eGraphics, *spritePipe.pipeset.layout, 0, {
+		spritePipe.pipeset.Get(0,0)
+	}, nullptr);
+	cmd->bindDescriptorSets(vk::PipelineBindPoint::eGraphics, *spritePipe.pipeset.layout, 1,
+		spritePipe.pipeset.Get(1,0), (uint32_t)(spriteInstances.copySize*frame));
+
+	for(const SpriteBatch::Batch &batch : batches)
+	{
+		cmd->draw(batch.vertexCount, batch.instanceCount, 0, first + batch.firstInstance);
+		spritesUsed += batch.instanceCount;
+	}
 }
 
 void GfxHandler::SetupParticlePipeline()
 {
-	maxParticles = renderer.uniformBufferSizeLimit/sizeof(ParticleGroup::Particle);
-
 	auto pBuilder = renderer.GetPipelineBuilder();
 	pBuilder
-		.SetSpecializationConstants({(int)textureQuads.size(), (int)maxParticles})
-		.HintDescriptorType(0, 0, vk::DescriptorType::eUniformBufferDynamic)
+		.SetSpecializationConstants({(int)textureQuads.size()})
+		.HintDescriptorType(0, 0, vk::DescriptorType::eStorageBufferDynamic)
 		.SetShaders("data/spirv/particle.vert.bin", "data/spirv/particle.frag.bin")
 		.SetPushConstants({
-			{.stageFlags = vk::ShaderStageFlagBits::eVertex | vk::ShaderStageFlagBits::eFragment, .size = sizeof(pcParticles)},
+			{.stageFlags = vk::ShaderStageFlagBits::eVertex | vk::ShaderStageFlagBits::eFragment, .size = sizeof(ParticleConstants)},
 		})
 	;
-	particlePipe.pipeline = pBuilder.Build(particlePipe.pipeset, {2});
+	particlePipe.pipeline = pBuilder.Build(particlePipe.pipeset);
 
-	size_t bufSize = 16 * maxParticles * sizeof(ParticleGroup::Particle);
+	//Mapped once and kept that way. The simulation thread writes to a slice and the snapshot carries its index.
+	size_t bufSize = maxParticles * sizeof(ParticleGroup::Particle);
 	particleProperties.Allocate(&renderer, bufSize,
-	vk::BufferUsageFlagBits::eUniformBuffer, vma::MemoryUsage::eCpuToGpu, renderer.bufferedFrames);
+	vk::BufferUsageFlagBits::eStorageBuffer, vma::MemoryUsage::eCpuToGpu, particleSlices);
+	particleProperties.Map();
+	for(int slice = 0; slice < particleSlices; ++slice)
+		freeParticleSlices.Push(slice);
 
 	std::vector<PipelineBuilder::WriteSetInfo> updateSetParams;
-	updateSetParams.reserve(textureQuads.size()+2);
-	for(short i = 0; i < renderer.bufferedFrames; i++) //Particle pos uniform buffer
-	{
-		updateSetParams.push_back({vk::DescriptorBufferInfo{ 
-			.buffer = particleProperties.buffer,
-			.offset = renderer.PadToAlignment(bufSize)*i,
-			.range = renderer.uniformBufferSizeLimit,
-		}, 0, 0, i});
-	}
+	updateSetParams.reserve(textureQuads.size()+1);
+	updateSetParams.push_back({vk::DescriptorBufferInfo{ //Particle properties, offset by frame.
+		.buffer = particleProperties.buffer,
+		.offset = 0,
+		.range = bufSize,
+	}, 0, 0});
 
 	for(int i = 0; i < textureQuads.size(); ++i) //Textures
 	{
@@ -324,40 +409,68 @@ void GfxHandler::SetupParticlePipeline()
 	pBuilder.UpdateSets(updateSetParams);
 }
 
-void GfxHandler::DrawParticles(const ParticleGroup &data)
+int GfxHandler::AcquireParticleSlice()
 {
-	auto frame = renderer.CurrentFrame();
-	auto buf = (uint8_t*)particleProperties.Map(frame);
+	int slice;
+	if(!freeParticleSlices.Pop(slice))
+		return -1;
+	return slice;
+}
+
+ParticleGroup::Particle *GfxHandler::ParticleSlice(int slice)
+{
+	return (ParticleGroup::Particle*)particleProperties.Map(slice);
+}
+
+void GfxHandler::ReleaseParticleSlice(int slice)
+{
+	if(slice < 0)
+		return;
+	if(sliceFrames[slice])
+		sliceReleased[slice] = true;
+	else
+		freeParticleSlices.Push(slice);
+}
 
-	auto drawList = data.FillBuffer(buf, renderer.uniformBufferSizeLimit, particleProperties.copySize, renderer.uniformBufferAlignment);
-	particleProperties.Unmap();
+void GfxHandler::DrawParticles(int slice, const std::vector<ParticleGroup::DrawInfo> &drawList, const glm::mat4 &transform, int layer)
+{
+	if(slice < 0)
+		return;
+	auto cmd = renderer.GetCommand(layer);
+	if(!cmd)
+		return;
+	if(cmd == this->cmd) //Keep the order with the sprites.
+		Flush();
+
+	sliceFrames[slice] |= 1 << renderer.CurrentFrame();
+	RecordParticles(cmd, slice, drawList, transform);
+}
+
+void GfxHandler::RecordParticles(const vk::CommandBuffer *cmd, int slice, const std::vector<ParticleGroup::DrawInfo> &drawList, const glm::mat4 &transform)
+{
 	if(drawList.empty())
 		return;
 
 	cmd->bindPipeline(vk::PipelineBindPoint::eGraphics, *particlePipe.pipeline);
+	cmd->bindDescriptorSets(vk::PipelineBindPoint::eGraphics, *particlePipe.pipeset.layout, 0, 
+		particlePipe.pipeset.Get(0,0), (uint32_t)(particleProperties.copySize*slice));
 	cmd->bindDescriptorSets(vk::PipelineBindPoint::eGraphics, *particlePipe.pipeset.layout, 1, 
 		particlePipe.pipeset.Get(1,0), nullptr);
 
-	pcParticles.transform = pcSprites.transform,
-	pcParticles.textureId = -1;
+	ParticleConstants pcParticles{transform, (uint32_t)-1};
 	cmd->pushConstants(*particlePipe.pipeset.layout, vk::ShaderStageFlagBits::eVertex | vk::ShaderStageFlagBits::eFragment,
-		offsetof(decltype(pcParticles), transform), sizeof(pcParticles.transform), &pcParticles.transform);
+		offsetof(ParticleConstants, transform), sizeof(pcParticles.transform), &pcParticles.transform);
 
 	for(const ParticleGroup::DrawInfo &drawInfo : drawList)
 	{
-		//Do not exceed addressable range;
-		if(renderer.uniformBufferSizeLimit + drawInfo.bufferOffset > particleProperties.copySize)
-			break;
-
 		if(pcParticles.textureId != drawInfo.particleType)
 		{
 			pcParticles.textureId = drawInfo.particleType;
 			cmd->pushConstants(*particlePipe.pipeset.layout, vk::ShaderStageFlagBits::eVertex | vk::ShaderStageFlagBits::eFragment, 
-				offsetof(decltype(pcParticles), textureId), sizeof(pcParticles.textureId), &pcParticles.textureId);
+				offsetof(ParticleConstants, textureId), sizeof(pcParticles.textureId), &pcParticles.textureId);
 		}
-		cmd->bindDescriptorSets(vk::PipelineBindPoint::eGraphics, *particlePipe.pipeset.layout,
-			0, particlePipe.pipeset.Get(0,frame), drawInfo.bufferOffset);
-		cmd->draw(drawInfo.particleAmount*6, 1, 0, 0);
+		//The shader fetches particle gl_VertexIndex/6, so the first vertex selects the range.
+		cmd->draw(drawInfo.particleAmount*6, 1, drawInfo.first*6, 0);
 	}
 }
 
@@ -373,27 +486,28 @@ void GfxHandler::SetMulColorRaw(float r, float g, float b, float a)
 
 int GfxHandler::GetVirtualId(int id, int defId)
 {
-	for(auto search: idMapList[defId])
+	const auto &idMap = idMapList[defId];
+	for(int i = 0; i < idMap.size(); ++i)
 	{
-		if(search.second.trueId == id)
-			return search.first;
+		if(idMap[i].trueId == id)
+			return i;
 	}
 	return -1;
 }
 
 void GfxHandler::SetMatrix(const glm::mat4 &matrix)
 {
-	pcSprites.transform = matrix;
+	currentSprite.transform = matrix;
 }
 
 void GfxHandler::SetPaletteSlot(int slot)
 {
-	pcSprites.paletteSlot = slot;
+	currentSprite.paletteSlot = slot;
 }
 
 void GfxHandler::SetPaletteIndex(int index)
 {
-	pcSprites.paletteIndex = index;
+	currentSprite.paletteIndex = index;
 }
 
 void GfxHandler::SetBlendingMode(int mode)
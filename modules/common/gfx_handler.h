@@ -5,7 +5,10 @@
 #include "vk/pipeset.hpp"
 
 #include "particle.h"
+#include "sprite_batch.h"
+#include "spsc_queue.h"
 #include "vertex_buffer.h"
+#include <vfs.h>
 
 
 #include <vector>
@@ -25,8 +28,9 @@ private:
 
 	struct spriteIdMeta
 	{
-		int trueId;
+		int trueId = -1; //-1 if there's no sprite with this id.
 		int textureIndex;
+		SpriteMesh mesh;
 	};
 
 	Renderer &renderer;
@@ -39,15 +43,19 @@ private:
 	//vk::raii::Pipeline spriteAdditive = nullptr;
 
 
-	std::vector<std::unique_ptr<VertexData4[]>> tempVDContainer;
+	std::vector<vfs::File> vertexFiles; //Vertex data is copied straight from these in LoadingDone.
 	VertexBuffer vertices;
 	
-	AllocatedBuffer particleProperties;
-	size_t maxParticles = 0;
+	AllocatedBuffer particleProperties; //One slice per snapshot that may hold particles.
+
+	SpriteBatch spriteBatch;
+	AllocatedBuffer spriteInstances;
+	static constexpr size_t maxSprites = 1 << 13; //Per frame.
+	size_t spritesUsed = 0; //This frame.
 
 	//One for each def load.
-	//Maps virtual id to real id;
-	std::vector<std::unordered_map<int, spriteIdMeta>> idMapList;
+	//Indexed by virtual id.
+	std::vector<std::vector<spriteIdMeta>> idMapList;
 
 	vk::raii::Sampler samplerI = nullptr;
 	vk::raii::Sampler sampler = nullptr;
@@ -60,26 +68,21 @@ private:
 
 	bool loaded = false;
 
-	struct{
-		glm::mat4 transform;
-		int32_t shaderType = 0;
-		int32_t textureIndex = 0;
-		int32_t paletteSlot = 0;
-		int32_t paletteIndex = 0;
-		glm::vec4 mulColor;
-	} pcSprites;
+	SpriteInstance currentSprite{};
 	glm::vec4 mulColor = {1,1,1,1};
 	float blendingModeFactor = 1.f;
 
-	struct{
+	//Local to each recording so particles can be recorded from any thread.
+	struct ParticleConstants{
 		glm::mat4 transform;
 		uint32_t textureId;
-	} pcParticles;
+	};
 
 	void LoadToVertexBuffer(std::filesystem::path file, int mapId, int textureIndex);
 
 	void SetupSpritePipeline();
 	void SetupParticlePipeline();
+	void RecordParticles(const vk::CommandBuffer *cmd, int slice, const std::vector<ParticleGroup::DrawInfo> &drawList, const glm::mat4 &transform);
 
 public:
 	GfxHandler(Renderer*);
@@ -94,11 +97,22 @@ public:
 	void SetPaletteSlot(int slot);
 	void SetPaletteIndex(int index);
 	void SetMatrix(const glm::mat4 &matrix);
-	void Draw(int id, int defId = 0);
-	void DrawParticles(const ParticleGroup &data);
-
-	//Returns true if you're allowed to draw.
-	bool Begin();
+	void Draw(int id, int defId = 0); //Queued until Flush.
+	void Flush(); //Records the queued sprites.
+
+	//Particles are packed by ParticleGroup::FillBuffer straight into mapped memory, one slice per snapshot.
+	//Enough for the three snapshots being passed around and the ones buffered frames may still be reading.
+	static constexpr int particleSlices = 3 + Renderer::bufferedFrames + 1;
+	static constexpr size_t maxParticles = 1 << 17; //Per slice.
+	int AcquireParticleSlice(); //Simulation thread. Returns -1 if every slice is in use.
+	ParticleGroup::Particle *ParticleSlice(int slice);
+	//Render thread, once the snapshot holding it is replaced. It's given out again when no buffered frame reads it.
+	void ReleaseParticleSlice(int slice);
+	//Can be recorded in another layer from a different thread while sprites are drawn.
+	void DrawParticles(int slice, const std::vector<ParticleGroup::DrawInfo> &drawList, const glm::mat4 &transform, int layer = 0);
+
+	//Returns true if you're allowed to draw. Sprites are recorded in the given layer.
+	bool Begin(int layer = 0);
 
 	bool isLoaded(){return loaded;}
 	void SetMulColor(float r, float g, float b, float a = 1.f);
@@ -114,6 +128,11 @@ public:
 	void SetBlendingMode(int mode);
 
 	int GetVirtualId(int id, int defId = 0); //Avoid using this
+
+private:
+	SpscQueue<int, 8> freeParticleSlices; //Given back by the render thread, taken by the simulation thread.
+	uint32_t sliceFrames[particleSlices] = {}; //Bit per buffered frame whose commands read the slice.
+	bool sliceReleased[particleSlices] = {};
 };
 
 #endif /* GFX_HANDLER_H_GUARD */
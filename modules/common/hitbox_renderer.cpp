@@ -74,13 +74,15 @@ renderer(renderer)
 	filling = pBuilder.BuildDerivate();
 }
 
-void HitboxRenderer::Draw(const glm::mat4 &transform)
+void HitboxRenderer::Draw(const glm::mat4 &transform, int layer)
 {
 	if(quadsToDraw > 0)
 	{
 		PushConstants pushConstants {transform, 0.1f};
 
-		auto cmd = renderer.GetCommand();
+		auto cmd = renderer.GetCommand(layer);
+		if(!cmd)
+			return;
 		cmd->bindVertexBuffers(0, vertices.buffer, {0});
 		cmd->bindIndexBuffer(indices.buffer, 0, vk::IndexType::eUint16);
 
@@ -155,6 +157,13 @@ void HitboxRenderer::GenerateHitboxVertices(const std::vector<float> &hitboxes,
 	acumFloats = dataI;
 }
 
+void HitboxRenderer::GenerateHitboxVertices(const HitboxList &list)
+{
+	for(int color = gray; color <= red; ++color)
+		if(!list.boxes[color].empty())
+			GenerateHitboxVertices(list.boxes[color], color);
+}
+
 void HitboxRenderer::LoadHitboxVertices()
 {
  	/* vGeometry.UpdateBuffer(geoVaoId, clientQuads.data(), acumQuads*sizeof(float));
@@ -8,6 +8,15 @@
 #include <vector>
 
 class Renderer;
+
+//Boxes gathered by the simulation, BLTR per box, for the renderer to upload later.
+struct HitboxList
+{
+	std::vector<float> boxes[3]; //Indexed by HitboxRenderer color.
+	void Add(const std::vector<float> &bltr, int color) { boxes[color].insert(boxes[color].end(), bltr.begin(), bltr.end()); }
+	void Clear() { for(auto &b : boxes) b.clear(); }
+};
+
 //Holds the state needed to render hitboxes for debug purposes.
 class HitboxRenderer
 {
@@ -22,9 +31,10 @@ public:
 	};
 
 	void GenerateHitboxVertices(const std::vector<float> &boxes, int pickedColor);
+	void GenerateHitboxVertices(const HitboxList &list);
 	void LoadHitboxVertices();
 	void DontDraw();
-	void Draw(const glm::mat4 &transform);
+	void Draw(const glm::mat4 &transform, int layer = 0);
 	void DrawAxisOnly(const glm::mat4 &transform, float alpha);
 
 private:
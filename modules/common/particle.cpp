@@ -1,23 +1,37 @@
 #include "particle.h"
 #include "xorshift.h"
+#include "worker_pool.h"
+#include <array>
 #include <cmath>
 #include <cassert>
+#include <cstring>
+#include <iostream>
+
+#if defined(__AVX2__)
+	#include <immintrin.h>
+	#define PARTICLE_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#include <emmintrin.h>
+	#define PARTICLE_SSE2
+#endif
 
 constexpr float pi = 3.1415926535897931;
+constexpr float floorY = 32;
+constexpr float bounceDamping = -0.65f;
+constexpr float minScale = 0.1f;
 
-ParticleGroup::ParticleGroup(XorShift32 &_rng)
+ParticleGroup::ParticleGroup(XorShift32 &_rng, WorkerPool *_workers, const EmitterTable *_emitters)
 {
 	rng = &_rng;
+	workers = _workers;
+	emitters = _emitters;
 	particleTypes.insert({
 		{0, {}},
 		{1, {}}
 	});
 
 	for(auto &[_, type] : particleTypes)
-	{
-		type.particleParams.reserve(512);
-		type.particles.reserve(512);
-	}
+		type.reserve(512);
 }
 
 ParticleGroup::ParticleGroup(const ParticleGroup &p)
@@ -29,6 +43,8 @@ ParticleGroup& ParticleGroup::operator=(const ParticleGroup &p)
 {
 	particleTypes = p.particleTypes;
 	rng = p.rng;
+	workers = p.workers;
+	emitters = p.emitters;
 	return *this;
 }
 
@@ -41,298 +57,421 @@ ParticleGroup& ParticleGroup::operator=(ParticleGroup &&p)
 {
 	particleTypes = std::move(p.particleTypes);
 	rng = p.rng;
+	workers = p.workers;
+	emitters = p.emitters;
 	return *this;
 }
 
-std::vector<ParticleGroup::DrawInfo> ParticleGroup::FillBuffer(uint8_t* buffer, size_t segmentSize, size_t maxSize, uint32_t aligment) const
+template<typename F>
+static void ForEachArray(ParticleGroup::ParticleTypeData &d, F &&f)
 {
-	std::vector<DrawInfo> amountPerId;
-	size_t remainingBytes = maxSize;
-	for(const auto &[id, data] : particleTypes)
+	for(int i = 0; i < 2; ++i)
 	{
-		size_t particlesCopied = 0;
-		if(data.particles.empty())
-			continue;
-		
-		auto& particles = data.particles;
-		const size_t particleAmount = particles.size(); 
+		f(d.pos[i]);
+		f(d.scale[i]);
+		f(d.vel[i]);
+		f(d.acc[i]);
+		f(d.growRate[i]);
+	}
+	for(auto &channel : d.color)
+		f(channel);
+	f(d.sin);
+	f(d.cos);
+	f(d.texId);
+	f(d.rotSin);
+	f(d.rotCos);
+	f(d.fadeRate);
+	f(d.remainingTicks);
+	f(d.bounce);
+}
 
-		while(particlesCopied < particleAmount)
-		{
-			//Size of the amount of particles to copy has to be less than the addressable segment size and can't go beyond the size of the buffer.
-			uint32_t particlesToCopy = std::min(std::min(particleAmount-particlesCopied, segmentSize/sizeof(Particle)), remainingBytes/sizeof(Particle));
-			uint32_t copiedBytes = particlesToCopy*sizeof(Particle);
+void ParticleGroup::ParticleTypeData::reserve(size_t n)
+{
+	ForEachArray(*this, [n](auto &v){v.reserve(n);});
+	keep.reserve(n);
+}
 
-			memcpy(buffer, data.particles.data()+particlesCopied, copiedBytes);
-			particlesCopied += particlesToCopy;
+size_t ParticleGroup::ParticleTypeData::Grow(size_t amount)
+{
+	size_t start = size();
+	size_t end = start + amount;
+	ForEachArray(*this, [end](auto &v){v.resize(end);});
+	for(auto &channel : color)
+		std::fill(channel.begin()+start, channel.end(), 255.f);
+	std::fill(cos.begin()+start, cos.end(), 1.f);
+	std::fill(rotCos.begin()+start, rotCos.end(), 1.f);
+	std::fill(fadeRate.begin()+start, fadeRate.end(), 1.f);
+	return start;
+}
 
-			//Push draw instance.
-			amountPerId.push_back({maxSize-remainingBytes, particlesToCopy, id});
+void ParticleGroup::ParticleTypeData::Compact(WorkerPool *workers)
+{
+	const size_t n = size();
+	keep.resize(n);
+	for(size_t i = 0; i < n; ++i)
+		keep[i] = (remainingTicks[i] >= 0) & (scale[0][i] >= minScale) & (scale[1][i] >= minScale);
+
+	size_t alive = 0;
+	for(size_t i = 0; i < n; ++i)
+		alive += keep[i];
+	if(alive == n)
+		return;
+
+	//Every element gets written to the current slot, the slot only advances if it's kept.
+	auto compact = [this, n, alive](auto &v){
+		size_t w = 0;
+		for(size_t i = 0; i < n; ++i)
+		{
+			v[w] = v[i];
+			w += keep[i];
+		}
+		v.resize(alive);
+	};
 
-			//Align buffer for next write.
-			copiedBytes = (copiedBytes + aligment - 1) & ~(aligment - 1);
-			buffer += copiedBytes;
-			remainingBytes -= copiedBytes;
+	if(workers && n >= parallelThreshold)
+	{
+		//One job per array.
+		std::vector<std::function<void()>> jobs;
+		ForEachArray(*this, [&](auto &v){
+			jobs.push_back([&compact, &v](){compact(v);});
+		});
+		workers->ParallelFor(jobs.size(), [&jobs](size_t i){jobs[i]();});
+	}
+	else
+		ForEachArray(*this, compact);
+}
 
-			if(remainingBytes == 0)
-				goto end;
+#if defined(PARTICLE_AVX2)
+	typedef __m256 vfloat;
+	typedef __m256i vint;
+	constexpr size_t simdWidth = 8;
+	static inline vfloat Load(const float *p) { return _mm256_loadu_ps(p); }
+	static inline vint Load(const int32_t *p) { return _mm256_loadu_si256((const vint*)p); }
+	static inline vint Load(const uint32_t *p) { return _mm256_loadu_si256((const vint*)p); }
+	static inline void Store(float *p, vfloat v) { _mm256_storeu_ps(p, v); }
+	static inline void Store(int32_t *p, vint v) { _mm256_storeu_si256((vint*)p, v); }
+	static inline vfloat Set1(float f) { return _mm256_set1_ps(f); }
+	static inline vfloat Add(vfloat a, vfloat b) { return _mm256_add_ps(a, b); }
+	static inline vfloat Sub(vfloat a, vfloat b) { return _mm256_sub_ps(a, b); }
+	static inline vfloat Mul(vfloat a, vfloat b) { return _mm256_mul_ps(a, b); }
+	static inline vfloat Trunc(vfloat a) { return _mm256_round_ps(a, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC); }
+	static inline vfloat Less(vfloat a, vfloat b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+	static inline vfloat Select(vfloat mask, vfloat a, vfloat b) { return _mm256_blendv_ps(b, a, mask); }
+	static inline vfloat NonZero(vint a) { return _mm256_castsi256_ps(_mm256_xor_si256(_mm256_cmpeq_epi32(a, _mm256_setzero_si256()), _mm256_set1_epi32(-1))); }
+	static inline vfloat And(vfloat a, vfloat b) { return _mm256_and_ps(a, b); }
+	static inline vint Decrement(vint a) { return _mm256_sub_epi32(a, _mm256_set1_epi32(1)); }
+#elif defined(PARTICLE_SSE2)
+	typedef __m128 vfloat;
+	typedef __m128i vint;
+	constexpr size_t simdWidth = 4;
+	static inline vfloat Load(const float *p) { return _mm_loadu_ps(p); }
+	static inline vint Load(const int32_t *p) { return _mm_loadu_si128((const vint*)p); }
+	static inline vint Load(const uint32_t *p) { return _mm_loadu_si128((const vint*)p); }
+	static inline void Store(float *p, vfloat v) { _mm_storeu_ps(p, v); }
+	static inline void Store(int32_t *p, vint v) { _mm_storeu_si128((vint*)p, v); }
+	static inline vfloat Set1(float f) { return _mm_set1_ps(f); }
+	static inline vfloat Add(vfloat a, vfloat b) { return _mm_add_ps(a, b); }
+	static inline vfloat Sub(vfloat a, vfloat b) { return _mm_sub_ps(a, b); }
+	static inline vfloat Mul(vfloat a, vfloat b) { return _mm_mul_ps(a, b); }
+	static inline vfloat Trunc(vfloat a) { return _mm_cvtepi32_ps(_mm_cvttps_epi32(a)); } //Colors fit in an int.
+	static inline vfloat Less(vfloat a, vfloat b) { return _mm_cmplt_ps(a, b); }
+	static inline vfloat Select(vfloat mask, vfloat a, vfloat b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+	static inline vfloat NonZero(vint a) { return _mm_castsi128_ps(_mm_xor_si128(_mm_cmpeq_epi32(a, _mm_setzero_si128()), _mm_set1_epi32(-1))); }
+	static inline vfloat And(vfloat a, vfloat b) { return _mm_and_ps(a, b); }
+	static inline vint Decrement(vint a) { return _mm_sub_epi32(a, _mm_set1_epi32(1)); }
+#else
+	constexpr size_t simdWidth = 1;
+#endif
+
+void ParticleGroup::ParticleTypeData::Step(size_t first, size_t last)
+{
+	size_t i = first;
+#if defined(PARTICLE_AVX2) || defined(PARTICLE_SSE2)
+	const vfloat floor = Set1(floorY);
+	const vfloat damping = Set1(bounceDamping);
+	for(; i + simdWidth <= last; i += simdWidth)
+	{
+		vfloat posX = Load(&pos[0][i]);
+		vfloat posY = Load(&pos[1][i]);
+		vfloat velX = Load(&vel[0][i]);
+		vfloat velY = Load(&vel[1][i]);
+
+		vfloat bounced = And(NonZero(Load(&bounce[i])), Less(posY, floor));
+		velY = Select(bounced, Mul(velY, damping), velY);
+		posY = Select(bounced, Add(floor, Sub(floor, posY)), posY);
+
+		Store(&pos[0][i], Add(posX, velX));
+		Store(&pos[1][i], Add(posY, velY));
+		Store(&vel[0][i], Add(velX, Load(&acc[0][i])));
+		Store(&vel[1][i], Add(velY, Load(&acc[1][i])));
+
+		vfloat fade = Load(&fadeRate[i]);
+		for(auto &channel : color)
+			Store(&channel[i], Trunc(Mul(Load(&channel[i]), fade)));
+
+		Store(&scale[0][i], Mul(Load(&scale[0][i]), Load(&growRate[0][i])));
+		Store(&scale[1][i], Mul(Load(&scale[1][i]), Load(&growRate[1][i])));
+
+		vfloat x = Load(&sin[i]);
+		vfloat y = Load(&cos[i]);
+		vfloat rs = Load(&rotSin[i]);
+		vfloat rc = Load(&rotCos[i]);
+		Store(&sin[i], Sub(Mul(x, rc), Mul(y, rs)));
+		Store(&cos[i], Add(Mul(x, rs), Mul(y, rc)));
+
+		Store(&remainingTicks[i], Decrement(Load(&remainingTicks[i])));
+	}
+#endif
+	//Remainder, or everything if there's no SIMD. Must give the same results as the vector path.
+	for(; i < last; ++i)
+	{
+		if(bounce[i] && pos[1][i] < floorY)
+		{
+			vel[1][i] = vel[1][i]*bounceDamping;
+			pos[1][i] = floorY+(floorY-pos[1][i]);
+		}
+		for(int j = 0; j < 2; ++j)
+		{
+			pos[j][i] += vel[j][i];
+			vel[j][i] += acc[j][i];
 		}
+		for(auto &channel : color)
+			channel[i] = std::trunc(channel[i]*fadeRate[i]);
+
+		scale[0][i] *= growRate[0][i];
+		scale[1][i] *= growRate[1][i];
+		float x = sin[i];
+		float y = cos[i];
+		sin[i] = x*rotCos[i] - y*rotSin[i];
+		cos[i] = x*rotSin[i] + y*rotCos[i];
+		remainingTicks[i] -= 1;
 	}
+}
 
-	end:
+void ParticleGroup::ParticleTypeData::Pack(Particle *out, size_t first, size_t count) const
+{
+	for(size_t i = first, end = first+count; i < end; ++i, ++out)
+	{
+		Particle p;
+		p.pos[0] = pos[0][i];
+		p.pos[1] = pos[1][i];
+		p.scale[0] = scale[0][i];
+		p.scale[1] = scale[1][i];
+		p.sin = sin[i];
+		p.cos = cos[i];
+		p.texId = texId[i];
+		for(int c = 0; c < 4; ++c)
+			p.color[c] = static_cast<uint8_t>(color[c][i]);
+		memcpy(out, &p, sizeof(Particle)); //Destination is usually mapped GPU memory.
+	}
+}
+
+std::vector<ParticleGroup::DrawInfo> ParticleGroup::FillBuffer(Particle* buffer, size_t capacity) const
+{
+	std::vector<DrawInfo> amountPerId;
+	size_t written = 0;
+	for(const auto &[id, data] : particleTypes)
+	{
+		uint32_t amount = std::min(data.size(), capacity-written);
+		if(amount == 0)
+			continue;
+		Particle *out = buffer+written;
+		if(workers && amount >= parallelThreshold)
+		{
+			workers->ParallelFor((amount + chunkSize - 1)/chunkSize, [&data, out, amount](size_t chunk){
+				size_t first = chunk*chunkSize;
+				data.Pack(out+first, first, std::min(chunkSize, amount-first));
+			});
+		}
+		else
+			data.Pack(out, 0, amount);
+		amountPerId.push_back({(uint32_t)written, amount, id});
+		written += amount;
+	}
 	return amountPerId;
 }
 
 void ParticleGroup::Update()
 {
-	for(auto &type : particleTypes)
+	for(auto &[_, data] : particleTypes)
 	{
-		auto& particles = type.second.particles;
-		auto& particleParams = type.second.particleParams;
-		for(int pi = 0, end = particles.size(); pi < end; ++pi)
+		data.Compact(workers);
+		const size_t n = data.size();
+		if(workers && n >= parallelThreshold)
 		{
-			auto& param = particleParams[pi];
-			auto& particle = particles[pi];
-			while((param.remainingTicks < 0 || particle.scale[0] < 0.1 || particle.scale[1] < 0.1) && pi < end)
-			{
-				param = particleParams.back();
-				particle = particles.back();
-				particleParams.pop_back();
-				particles.pop_back();
-				--end;
-			}
-			if(param.bounce && particle.pos[1] < 32)
-			{
-				param.vel[1] = -param.vel[1]*0.65;
-				particle.pos[1] = 32+(32-particle.pos[1]);
-			}
-			for(int i = 0; i < 2; ++i)
-			{
-				particle.pos[i] += param.vel[i];
-				param.vel[i] += param.acc[i];
-			}
-			for(int i = 0; i < 4; ++i)
-				particle.color[i] *= param.fadeRate;
-
-			particle.scale[0] *= param.growRate[0];
-			particle.scale[1] *= param.growRate[1]; 
-			float x = particle.sin;
-			float y = particle.cos;
-			particle.sin = x*param.rotCos - y*param.rotSin;
-			particle.cos = x*param.rotSin + y*param.rotCos;
-			param.remainingTicks -= 1;
+			workers->ParallelFor((n + chunkSize - 1)/chunkSize, [&data, n](size_t chunk){
+				data.Step(chunk*chunkSize, std::min(chunk*chunkSize + chunkSize, n));
+			});
 		}
+		else
+			data.Step(0, n);
 	}
 }
 
-constexpr float max32 = static_cast<float>(std::numeric_limits<int32_t>::max());
-constexpr float max32u = static_cast<float>(std::numeric_limits<uint32_t>::max());
+//Sine for a full turn in angle table units. Cosine is the same table a quarter turn ahead.
+static const std::array<float, emitterAngleSteps> sinTable = []{
+	std::array<float, emitterAngleSteps> table;
+	for(int i = 0; i < emitterAngleSteps; ++i)
+		table[i] = std::sin(2*pi*i/emitterAngleSteps);
+	return table;
+}();
+constexpr int angleMask = emitterAngleSteps-1;
+constexpr int quarterTurn = emitterAngleSteps/4;
+
+//Uniform float in [0,1) from the top 24 bits.
+static inline float Unit(uint32_t r)
+{
+	return (r >> 8)*(1.f/16777216.f);
+}
 
-void ParticleGroup::PushNormalHit(int amount, float x, float y)
+//Random numbers are only drawn if the range isn't constant.
+static void FillRange(float *out, size_t n, EmitterRange range, XorShift32x8 &gen, uint32_t *scratch)
 {
-	constexpr float deceleration = -0.04;
-	constexpr float maxSpeed = 12;
+	if(range.Constant())
+	{
+		std::fill(out, out+n, range.min);
+		return;
+	}
+	gen.Fill(scratch, n);
+	const float spread = range.max - range.min;
+	for(size_t i = 0; i < n; ++i)
+		out[i] = range.min + spread*Unit(scratch[i]);
+}
+
+//Fills n particles starting at first. Goes field by field so every loop is a simple pass over the arrays.
+static void SpawnLayer(const EmitterLayer &layer, ParticleGroup::ParticleTypeData &d, size_t first, size_t n, float x, float y, uint32_t seed)
+{
+	assert(n <= ParticleGroup::chunkSize);
+	XorShift32x8 gen(seed);
+	uint32_t scratch[ParticleGroup::chunkSize];
+	float angles[ParticleGroup::chunkSize];
+
+	std::fill_n(&d.pos[0][first], n, x);
+	std::fill_n(&d.pos[1][first], n, y);
+	std::fill_n(&d.texId[first], n, layer.type);
+	std::fill_n(&d.remainingTicks[first], n, layer.lifetime);
+	std::fill_n(&d.bounce[first], n, layer.bounce);
+
+	FillRange(&d.scale[0][first], n, layer.scale[0], gen, scratch);
+	if(layer.sameScale)
+		std::copy_n(&d.scale[0][first], n, &d.scale[1][first]);
+	else
+		FillRange(&d.scale[1][first], n, layer.scale[1], gen, scratch);
+
+	FillRange(&d.growRate[0][first], n, layer.grow[0], gen, scratch);
+	if(layer.sameGrow)
+		std::copy_n(&d.growRate[0][first], n, &d.growRate[1][first]);
+	else
+		FillRange(&d.growRate[1][first], n, layer.grow[1], gen, scratch);
+
+	if(layer.fadeWithGrow)
+		std::copy_n(&d.growRate[0][first], n, &d.fadeRate[first]);
+	else
+		std::fill_n(&d.fadeRate[first], n, layer.fade);
+
+	for(int c = 0; c < 4; ++c)
+	{
+		float *color = &d.color[c][first];
+		FillRange(color, n, layer.color[c], gen, scratch);
+		for(size_t i = 0; i < n; ++i)
+			color[i] = std::trunc(color[i]);
+	}
+
+	float *velX = &d.vel[0][first];
+	float *velY = &d.vel[1][first];
+	FillRange(velX, n, layer.speed[0], gen, scratch);
+	FillRange(velY, n, layer.speed[1], gen, scratch);
+	if(layer.squareSpeed)
+	{
+		for(size_t i = 0; i < n; ++i)
+		{
+			velX[i] *= std::abs(velX[i]);
+			velY[i] *= std::abs(velY[i]);
+		}
+	}
 
-	auto &particles = particleTypes[0].particles;
-	auto &particleParams = particleTypes[0].particleParams;
+	float *sin = &d.sin[first];
+	float *cos = &d.cos[first];
+	if(layer.alignToVelocity)
+	{
+		for(size_t i = 0; i < n; ++i)
+		{
+			float length = std::sqrt(velX[i]*velX[i] + velY[i]*velY[i]);
+			float c = length > 0 ? velX[i]/length : 1.f;
+			float s = length > 0 ? velY[i]/length : 0.f;
+			cos[i] = c;
+			sin[i] = s;
+			velX[i] += c*layer.speedBoost;
+			velY[i] += s*layer.speedBoost;
+		}
+	}
+	else
+	{
+		FillRange(angles, n, layer.angle, gen, scratch);
+		for(size_t i = 0; i < n; ++i)
+		{
+			int index = static_cast<int>(angles[i]);
+			sin[i] = sinTable[index & angleMask];
+			cos[i] = sinTable[(index + quarterTurn) & angleMask];
+		}
+	}
 
-	int start = particles.size();
-	particles.resize(start+amount);
-	particleParams.resize(start+amount);
+	float *accX = &d.acc[0][first];
+	float *accY = &d.acc[1][first];
+	for(size_t i = 0; i < n; ++i)
 	{
-		float angle = 2*pi*(float)(rng->GetU())/max32u;
-		auto &param = particleParams[start];
-		auto &particle = particles[start];
-		param = {};
-		particle.texId = 1;
-		particle.sin = sin(angle);
-		particle.cos = cos(angle);
-		particle.pos[0] = x;
-		particle.pos[1] = y;
-		particle.scale[0] = 80;
-		particle.scale[1] = 40;
-
-		particle.color[0] = 255;
-		particle.color[1] = 64; 
-		particle.color[2] = 64;  
-		particle.color[3] = 128;
-
-		param.growRate[0] = 1.025;
-		param.growRate[1] = 0.70;
-		param.rotSin = 0;
-		param.rotCos = 1;
-		param.remainingTicks = 12;
-
-		
+		accX[i] = velX[i]*layer.drag[0];
+		accY[i] = (layer.dragDown ? -std::abs(velY[i]) : velY[i])*layer.drag[1] + layer.gravity;
 	}
-	for(int i = start+1; i < start+amount; ++i)
+
+	FillRange(angles, n, layer.rotation, gen, scratch);
+	float *rotSin = &d.rotSin[first];
+	float *rotCos = &d.rotCos[first];
+	for(size_t i = 0; i < n; ++i)
 	{
-		float angle = 0.3f*(float)(rng->Get())/max32;
-		auto &param = particleParams[i];
-		auto &particle = particles[i];
-		
-		particle.texId = 1;
-		particle.cos = 1;
-		particle.sin = 0;
-		particle.pos[0] = x;
-		particle.pos[1] = y;
-		particle.scale[0] = 14;
-		particle.scale[1] = 14;
-
-		particle.color[0] = 255;  //(rng->GetU())%128+127;
-		particle.color[1] = 128;  //(rng->GetU())%128+127;
-		particle.color[2] = 128;  //(rng->GetU())%128+127; 
-		particle.color[3] = 0;
-
-		param.bounce = false;
-		param.rotSin = sin(angle);
-		param.rotCos = cos(angle);
-		param.vel[0] = maxSpeed*(float)(rng->Get())/max32;
-		param.vel[1] = maxSpeed*(float)(rng->Get())/max32;
-		param.acc[0] = param.vel[0]*deceleration;
-		param.acc[1] = param.vel[1]*deceleration - 0.1;
-		param.growRate[0] = 0.90f - 0.2*(float)(rng->GetU())/max32u;
-		param.growRate[1] = param.growRate[0];
-		param.remainingTicks = 20;
+		int index = static_cast<int>(angles[i] + velX[i]*layer.spinFromSpeed);
+		rotSin[i] = sinTable[index & angleMask];
+		rotCos[i] = sinTable[(index + quarterTurn) & angleMask];
 	}
 }
 
-void ParticleGroup::PushCounterHit(int amount, float x, float y)
+void ParticleGroup::Emit(int emitterId, int amount, float x, float y)
 {
-	constexpr float deceleration = 0.01;
-	constexpr float maxSpeed = 2.5;
-	//float scale = fmax(amount/20.f, 0.5);
-	amount*=5;
-
-
-	auto &particles = particleTypes[1].particles;
-	auto &particleParams = particleTypes[1].particleParams;
-
-	auto &particles0 = particleTypes[0].particles;
-	auto &particle0Params = particleTypes[0].particleParams;
-
-	int start = particles.size();
-	particles.resize(start+amount);
-	particleParams.resize(start+amount);
-
- 	{
-		int start0 = particles0.size();
-		particles0.resize(start0+1);
-		particle0Params.resize(start0+1);
-		auto &param = particle0Params[start0];
-		auto &particle = particles0[start0];
-		param = {};
-		particle.sin = 0;
-		particle.cos = 1;
-		particle.pos[0] = x;
-		particle.pos[1] = y;
-		particle.scale[0] = 120;
-		particle.scale[1] = 120;
-		param.growRate[0] = 0.85;
-		param.growRate[1] = 0.85;
-		particle.color[0] = 64;
-		particle.color[1] = 128;
-		particle.color[2] = 255;
-		particle.color[3] = 255;
-		param.fadeRate = 0.80;
-		param.rotSin = 0;
-		param.rotCos = 1;
-		param.remainingTicks = 20;
-	}
-	for(int i = start; i < start+amount; ++i)
+	if(!emitters || emitterId == EmitterTable::none)
+		return;
+
+	for(const EmitterLayer &layer : emitters->Get(emitterId).layers)
 	{
-		float angle = 0.3f*(float)(rng->Get())/max32;
-		auto &param = particleParams[i];
-		auto &particle = particles[i];
-		
-		particle.texId = 0;
-		particle.cos = 1;
-		particle.sin = 0;
-		particle.pos[0] = x;
-		particle.pos[1] = y;
-		particle.scale[0] = 15.5f - 10.0*(float)(rng->GetU())/max32u;
-		particle.scale[1] = particle.scale[0];
-		//memset(particle.color, 0xFF, 4);
-
-		particle.color[0] = (rng->GetU())%256;
-		particle.color[1] = (rng->GetU())%200+56;
-		particle.color[2] = (rng->GetU())%128+128;
-		particle.color[3] = 0;
-
-		
-		param.bounce = true;
-	
-		float velx = param.vel[0] = maxSpeed*(float)(rng->Get())/max32;
-		float vely = param.vel[1] = 2*maxSpeed*(float)(rng->Get())/max32;
-		param.vel[0] *= abs(param.vel[0]);
-		param.vel[1] *= abs(param.vel[1]);
-		param.acc[0] = param.vel[0]*deceleration;
-		param.acc[1] = -abs(param.vel[1])*deceleration - 0.4;
-		param.growRate[0] = 0.99f - 0.1*(float)(rng->GetU())/max32u;
-		param.growRate[1] = param.growRate[0];
-		param.remainingTicks = 120;
-		param.fadeRate = param.growRate[0];
-
-		angle += param.vel[0]*0.03;
-		param.rotSin = sin(angle);
-		param.rotCos = cos(angle);
-		
+		const size_t n = layer.Amount(amount);
+		if(n == 0)
+			continue;
+
+		auto &d = particleTypes[layer.type];
+		const size_t start = d.Grow(n);
+		//Each chunk gets its own stream so the result is the same no matter how chunks are distributed.
+		const XorShift32 base{rng->GetU()};
+		auto spawnChunk = [&](size_t chunk){
+			size_t begin = chunk*chunkSize;
+			SpawnLayer(layer, d, start+begin, std::min(chunkSize, n-begin), x, y, base.Fork(chunk).a);
+		};
+
+		const size_t chunks = (n + chunkSize - 1)/chunkSize;
+		if(workers && n >= parallelThreshold)
+			workers->ParallelFor(chunks, spawnChunk);
+		else for(size_t chunk = 0; chunk < chunks; ++chunk)
+			spawnChunk(chunk);
 	}
 }
 
-void ParticleGroup::PushSlash(int amount, float x, float y)
+void ParticleGroup::Emit(const std::string &name, int amount, float x, float y)
 {
-	constexpr float deceleration = -0.02;
-
-	auto &particles = particleTypes[0].particles;
-	auto &particleParams = particleTypes[0].particleParams;
-
-	int start = particles.size();
-	particles.resize(start+amount);
-	particleParams.resize(start+amount);
- 	{
-		auto &param = particleParams[start];
-		auto &particle = particles[start];
-		param = {};
-		particle.texId = 1;
-		particle.sin = 0;
-		particle.cos = 1;
-		particle.pos[0] = x;
-		particle.pos[1] = y;
-		particle.scale[0] = 1.5;
-		particle.scale[1] = 1.5;
-		param.growRate[0] = 0.80;
-		param.growRate[1] = 0.80;
-		param.remainingTicks = 10;
-		param.rotSin = 0;
-		param.rotCos = 1;
-	}
-	for(int i = start+1; i < start+amount; ++i)
+	if(!emitters)
+		return;
+	int id = emitters->Find(name);
+	if(id == EmitterTable::none)
 	{
-		auto &param = particleParams[i];
-		auto &particle = particles[i];
-		particle.texId = 1;
-		particle.pos[0] = x;
-		particle.pos[1] = y;
-		particle.scale[0] = 80.0;
-		particle.scale[1] = 6.8;
-		param.vel[0] = 15*(float)(rng->Get())/max32;
-		param.vel[1] = 15*(float)(rng->Get())/max32;
-
-		float sqvx = sqrt((param.vel[0]*param.vel[0])+(param.vel[1]*param.vel[1]));
-		
-		//float sqvy = sqrt(param.vel[0]*param.vel[1]);
-		particle.cos = param.vel[0] /sqvx;
-		particle.sin = param.vel[1] /sqvx;
-		param.rotSin = 0;
-		param.rotCos = 1;
-		param.vel[0] += particle.cos;
-		param.vel[1] += particle.sin;
-		param.acc[0] = param.vel[0]*deceleration;
-		param.acc[1] = param.vel[1]*deceleration;
-		param.growRate[0] = 0.95f - 0.04*(float)(rng->GetU())/max32u;
-		param.growRate[1] = param.growRate[0];
-		param.remainingTicks = 40;
+		std::cerr << "There's no particle emitter called " << name << "\n";
+		return;
 	}
+	Emit(id, amount, x, y);
 }
-
@@ -2,9 +2,13 @@
 #define PARTICLE_H_GUARD
 
 #include <functional>
+#include <string>
 #include <unordered_map>
 #include <vector>
 #include "xorshift.h"
+#include "particle_emitter.h"
+
+class WorkerPool;
 
 class ParticleGroup
 {
@@ -20,43 +24,69 @@ public:
 		uint8_t color[4] = {0xFF,0xFF,0xFF,0xFF};
 	};
 
-	//For calculation only.
-	struct Params{
-		float vel[2];
-		float acc[2];
-		float growRate[2];
-		float rotSin; //Rotation speed
-		float rotCos;
-		int remainingTicks;
-		bool bounce = false;
-		float fadeRate = 1.f;
-	};
-
+	//Structure of arrays, one entry per particle in each vector, so Update can work on several particles at once.
+	//FillBuffer packs them back into Particle.
 	struct ParticleTypeData{
-		std::vector<Particle> particles;
-		std::vector<Params> particleParams;
+		std::vector<float> pos[2];
+		std::vector<float> scale[2];
+		std::vector<float> sin;
+		std::vector<float> cos;
+		std::vector<uint32_t> texId;
+		std::vector<float> color[4]; //Kept as whole numbers in [0,255].
+
+		std::vector<float> vel[2];
+		std::vector<float> acc[2];
+		std::vector<float> growRate[2];
+		std::vector<float> rotSin; //Rotation speed
+		std::vector<float> rotCos;
+		std::vector<float> fadeRate;
+		std::vector<int32_t> remainingTicks;
+		std::vector<uint32_t> bounce;
+
+		size_t size() const { return texId.size(); }
+		bool empty() const { return texId.empty(); }
+		void reserve(size_t n);
+		//New particles are white, don't move, rotate, grow or fade and never expire.
+		size_t Grow(size_t amount);
+		//Removes expired particles and the ones that shrunk too much, keeping the order.
+		//Each array is compacted as a separate job if workers are given.
+		void Compact(WorkerPool *workers = nullptr);
+		//Advances particles in [first, last).
+		void Step(size_t first, size_t last);
+		void Pack(Particle *out, size_t first, size_t count) const;
+
+	private:
+		std::vector<uint8_t> keep;
 	};
 	std::unordered_map<uint32_t, ParticleTypeData> particleTypes;
 
 
-	ParticleGroup(XorShift32& rng);
+	//Past this many particles work is split in chunks of chunkSize between the workers.
+	//Chunks don't depend on the thread count, and each spawn chunk gets its own rng stream, so results are always the same.
+	static constexpr size_t parallelThreshold = 8192;
+	static constexpr size_t chunkSize = 2048;
+
+	ParticleGroup(XorShift32& rng, WorkerPool *workers = nullptr, const EmitterTable *emitters = nullptr);
 	ParticleGroup& operator=(const ParticleGroup &p);
 	ParticleGroup (const ParticleGroup &p);
 	ParticleGroup& operator=(ParticleGroup &&p);
 	ParticleGroup (ParticleGroup &&p);
 	XorShift32 *rng = nullptr;
+	WorkerPool *workers = nullptr;
+	const EmitterTable *emitters = nullptr;
 	void Update();
-	void PushNormalHit(int amount, float x, float y);
-	void PushCounterHit(int amount, float x, float y);
-	void PushSlash(int amount, float x, float y);
+	//Amount scales the layers that have perAmount set.
+	void Emit(int emitterId, int amount, float x, float y);
+	void Emit(const std::string &name, int amount, float x, float y);
 
-	//Returns list of (amount (up to the segment size), type of particle) for drawing.
+	//Packs every particle into buffer, which is usually a slice of persistently mapped GPU memory.
+	//Particles past capacity are dropped. Returns the range of the buffer used by each particle type.
 	struct DrawInfo{
-		size_t bufferOffset;
+		uint32_t first;
 		uint32_t particleAmount;
 		uint32_t particleType;
 	};
-	std::vector<DrawInfo> FillBuffer(uint8_t* buffer, size_t segmentSize, size_t maxSize, uint32_t aligment) const;
+	std::vector<DrawInfo> FillBuffer(Particle* buffer, size_t capacity) const;
 };
 
 #endif /* PARTICLE_H_GUARD */
@@ -0,0 +1,125 @@
+#include "particle_emitter.h"
+#include "script_file.h"
+#include "trace.h"
+#include <sol/sol.hpp>
+#include <iostream>
+
+//Accepts either a number or a {min, max} table.
+static EmitterRange GetRange(sol::object value, EmitterRange fallback, float factor = 1.f)
+{
+	EmitterRange range = fallback;
+	if(value.get_type() == sol::type::number)
+	{
+		range.min = range.max = value.as<float>()*factor;
+	}
+	else if(value.get_type() == sol::type::table)
+	{
+		sol::table t = value;
+		float min = t[1].get_or(0.f);
+		float max = t[2].get_or(min);
+		range = {min*factor, max*factor};
+	}
+	return range;
+}
+
+static EmitterLayer ReadLayer(const sol::table &t)
+{
+	constexpr float toAngle = emitterAngleSteps/360.f;
+	EmitterLayer layer;
+	layer.type = t["type"].get_or(0);
+	layer.count = t["count"].get_or(0);
+	layer.perAmount = t["perAmount"].get_or(0);
+
+	sol::object scale = t["scale"];
+	if(scale.valid())
+		layer.scale[0] = GetRange(scale, layer.scale[0]);
+	else
+	{
+		layer.sameScale = false;
+		layer.scale[0] = GetRange(t["scaleX"], layer.scale[0]);
+		layer.scale[1] = GetRange(t["scaleY"], layer.scale[1]);
+	}
+
+	sol::object grow = t["grow"];
+	if(grow.valid())
+		layer.grow[0] = GetRange(grow, layer.grow[0]);
+	else
+	{
+		layer.sameGrow = false;
+		layer.grow[0] = GetRange(t["growX"], layer.grow[0]);
+		layer.grow[1] = GetRange(t["growY"], layer.grow[1]);
+	}
+
+	layer.angle = GetRange(t["angle"], {}, toAngle);
+	layer.rotation = GetRange(t["rotation"], {}, toAngle);
+	layer.spinFromSpeed = t["spinFromSpeed"].get_or(0.f)*toAngle;
+	layer.speed[0] = GetRange(t["speedX"], {});
+	layer.speed[1] = GetRange(t["speedY"], {});
+	layer.squareSpeed = t["squareSpeed"].get_or(false);
+	layer.alignToVelocity = t["alignToVelocity"].get_or(false);
+	layer.speedBoost = t["speedBoost"].get_or(0.f);
+
+	sol::optional<sol::table> drag = t["drag"];
+	if(drag)
+	{
+		layer.drag[0] = drag.value()[1].get_or(0.f);
+		layer.drag[1] = drag.value()[2].get_or(0.f);
+	}
+	layer.dragDown = t["dragDown"].get_or(false);
+	layer.gravity = t["gravity"].get_or(0.f);
+
+	sol::optional<sol::table> color = t["color"];
+	if(color)
+	{
+		for(int i = 0; i < 4; ++i)
+			layer.color[i] = GetRange(color.value()[i+1], layer.color[i]);
+	}
+	layer.fade = t["fade"].get_or(1.f);
+	layer.fadeWithGrow = t["fadeWithGrow"].get_or(false);
+	layer.lifetime = t["lifetime"].get_or(0);
+	layer.bounce = t["bounce"].get_or(false);
+	return layer;
+}
+
+void EmitterTable::LoadFromLua(const std::filesystem::path &file)
+{
+	TRACE_ZONE("EmitterTable::LoadFromLua");
+	sol::state lua;
+	auto result = ScriptFile(lua, file);
+	if(!result.valid()){
+		sol::error err = result;
+		std::cerr << "When loading " << file <<"\n";
+		std::cerr << err.what() << std::endl;
+		throw std::runtime_error("Lua syntax error.");
+	}
+
+	sol::optional<sol::table> emitterTable = lua["emitters"];
+	if(!emitterTable)
+	{
+		std::cerr << file << " doesn't define an emitters table.\n";
+		return;
+	}
+
+	for(auto &[key, value] : emitterTable.value())
+	{
+		auto name = key.as<std::string>();
+		if(names.count(name) > 0) //Already loaded from another file.
+			continue;
+
+		Emitter emitter;
+		sol::table layers = value;
+		for(size_t i = 1; i <= layers.size(); ++i)
+			emitter.layers.push_back(ReadLayer(layers[i].get<sol::table>()));
+
+		names.insert({name, (int)emitters.size()});
+		emitters.push_back(std::move(emitter));
+	}
+}
+
+int EmitterTable::Find(const std::string &name) const
+{
+	auto search = names.find(name);
+	if(search != names.end())
+		return search->second;
+	return none;
+}
@@ -0,0 +1,73 @@
+#ifndef PARTICLE_EMITTER_H_GUARD
+#define PARTICLE_EMITTER_H_GUARD
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+//A full turn in angle table units. Must be a power of two.
+constexpr int emitterAngleSteps = 4096;
+
+//Value picked uniformly from [min, max] for every particle. No random numbers are drawn if min == max.
+struct EmitterRange
+{
+	float min = 0;
+	float max = 0;
+	bool Constant() const { return min == max; }
+};
+
+//One group of particles spawned by an emitter, with everything already converted to the units Spawn works in.
+struct EmitterLayer
+{
+	uint32_t type = 0;
+	int count = 0;
+	int perAmount = 0;
+
+	EmitterRange scale[2] = {{1,1},{1,1}};
+	bool sameScale = true; //scale[1] reuses the value picked for scale[0].
+	EmitterRange grow[2] = {{1,1},{1,1}};
+	bool sameGrow = true;
+	EmitterRange angle; //Angle table units.
+	EmitterRange rotation; //Angle table units.
+	float spinFromSpeed = 0;
+	EmitterRange speed[2];
+	bool squareSpeed = false;
+	bool alignToVelocity = false;
+	float speedBoost = 0;
+	float drag[2] = {};
+	bool dragDown = false;
+	float gravity = 0;
+	EmitterRange color[4] = {{255,255},{255,255},{255,255},{255,255}};
+	float fade = 1;
+	bool fadeWithGrow = false;
+	int lifetime = 0;
+	bool bounce = false;
+
+	int Amount(int amount) const { return std::max(count + perAmount*amount, 0); }
+};
+
+struct Emitter
+{
+	std::vector<EmitterLayer> layers;
+};
+
+//Emitter descriptors loaded from data/fx/emitters.lua.
+class EmitterTable
+{
+public:
+	static constexpr int none = -1;
+
+	//Throws if the file can't be read.
+	void LoadFromLua(const std::filesystem::path &file);
+	int Find(const std::string &name) const; //Returns none if there's no such emitter.
+	const Emitter &Get(int id) const { return emitters[id]; }
+
+private:
+	std::vector<Emitter> emitters;
+	std::unordered_map<std::string, int> names;
+};
+
+#endif /* PARTICLE_EMITTER_H_GUARD */
@@ -0,0 +1,18 @@
+#include "script_file.h"
+#include "trace.h"
+#include <vfs.h>
+
+sol::protected_function_result ScriptFile(sol::state_view lua, const std::filesystem::path &file)
+{
+	auto name = file.generic_string();
+	TRACE_ZONE_DETAIL("Lua script", name);
+	auto data = vfs::Open(file);
+	if(!data)
+	{
+		lua_State *L = lua.lua_state();
+		lua_pushfstring(L, "cannot open %s", name.c_str());
+		return sol::protected_function_result(L, lua_gettop(L), 1, 1, sol::call_status::file);
+	}
+	//The @ prefix makes Lua show it as a filename in error messages.
+	return lua.safe_script(data.View(), sol::script_pass_on_error, "@" + name);
+}
@@ -0,0 +1,10 @@
+#ifndef SCRIPT_FILE_H_GUARD
+#define SCRIPT_FILE_H_GUARD
+
+#include <sol/sol.hpp>
+#include <filesystem>
+
+//Like sol::state::script_file, but the file is read through vfs. Errors are returned, never thrown.
+sol::protected_function_result ScriptFile(sol::state_view lua, const std::filesystem::path &file);
+
+#endif /* SCRIPT_FILE_H_GUARD */
@@ -2,8 +2,6 @@
 layout (location = 0) out vec2 oTexCoord;
 layout (location = 1) out flat vec4 oColor;
 
-layout (constant_id = 1) const int ParticleLimit = 1;
-
 const float qSize = 1;
 const vec2 quad[6] = vec2[6](
 	vec2(-qSize, -qSize), vec2(qSize, -qSize), vec2(qSize, qSize),
@@ -29,8 +27,8 @@ struct ParticleProp{
 	uint colorPacked;
 };
 
-layout(set = 0, binding = 0) uniform ObjectBuffer{
-	ParticleProp properties[ParticleLimit];
+layout(std430, set = 0, binding = 0) readonly buffer ObjectBuffer{
+	ParticleProp properties[];
 };
 
 void main()
@@ -1,5 +1,7 @@
 #version 460 core
 layout(location = 0) in vec2 iTexCoord;
+layout(location = 1) in flat vec4 mulColor;
+layout(location = 2) in flat ivec4 iParams;
 
 layout(location = 0) out vec4 oColor;
 
@@ -11,15 +13,11 @@ layout(set = 0, binding = 1) uniform usampler2D texI[NumberOfIndexedTextures];
 layout(set = 0, binding = 2) uniform sampler2D tex[NumberOfTextures];
 //uniform vec4 mulColor;b
 
-layout (push_constant) uniform Common
-{
-	mat4 transform;
-	int shaderType;
-	int textureIndex;
-	int paletteSlot;
-	int paletteIndex;
-	vec4 mulColor;
-};
+//Every instance in a draw uses the same shader type and texture, so they're uniform within it.
+#define shaderType iParams.x
+#define textureIndex iParams.y
+#define paletteSlot iParams.z
+#define paletteIndex iParams.w
 
 vec4 IndexedSample(ivec2 texCoord)
 {
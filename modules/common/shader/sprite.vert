@@ -1,21 +1,43 @@
 #version 460 core
-layout (location = 0) in ivec2 iPos;
-layout (location = 1) in ivec2 iTexCoord;
-
 layout (location = 0) out vec2 oTexCoord;
+layout (location = 1) out flat vec4 oMulColor;
+layout (location = 2) out flat ivec4 oParams; //shaderType, textureIndex, paletteSlot, paletteIndex
 
-layout (push_constant) uniform Common
-{
+struct SpriteInstance{
 	mat4 transform;
+	vec4 mulColor;
 	int shaderType;
 	int textureIndex;
 	int paletteSlot;
 	int paletteIndex;
-	vec4 mulColor;
+	uint firstVertex;
+	uint vertexCount;
+};
+
+layout(std430, set = 1, binding = 0) readonly buffer InstanceBuffer{
+	SpriteInstance instances[];
+};
+
+//Position and texture coordinates, as two pairs of 16 bit integers.
+layout(std430, set = 1, binding = 1) readonly buffer VertexBuffer{
+	ivec2 vertices[];
 };
 
 void main()
 {
-	gl_Position = transform * vec4(iPos, 0.0, 1.0);
-	oTexCoord = vec2(iTexCoord);
-}
\ No newline at end of file
+	SpriteInstance instance = instances[gl_InstanceIndex];
+	//The draw covers the biggest mesh in the batch. Smaller ones put the rest outside the clip volume.
+	uint index = uint(gl_VertexIndex);
+	if(index >= instance.vertexCount)
+	{
+		gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+		return;
+	}
+	ivec2 vertex = vertices[instance.firstVertex + index];
+	ivec2 pos = ivec2(bitfieldExtract(vertex.x, 0, 16), bitfieldExtract(vertex.x, 16, 16));
+	ivec2 texCoord = ivec2(bitfieldExtract(vertex.y, 0, 16), bitfieldExtract(vertex.y, 16, 16));
+	gl_Position = instance.transform * vec4(pos, 0.0, 1.0);
+	oTexCoord = vec2(texCoord);
+	oMulColor = instance.mulColor;
+	oParams = ivec4(instance.shaderType, instance.textureIndex, instance.paletteSlot, instance.paletteIndex);
+}
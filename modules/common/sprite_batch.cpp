@@ -0,0 +1,44 @@
+#include "sprite_batch.h"
+#include <algorithm>
+#include <cstring>
+
+void SpriteBatch::Add(const SpriteMesh &mesh, SpriteInstance instance)
+{
+	instance.firstVertex = mesh.firstVertex;
+	instance.vertexCount = mesh.vertexCount;
+	instances.push_back(instance);
+}
+
+const std::vector<SpriteBatch::Batch> &SpriteBatch::Build(SpriteInstance *out, size_t capacity)
+{
+	batches.clear();
+	size_t count = std::min(instances.size(), capacity);
+	if(count > 0)
+		std::memcpy(out, instances.data(), count*sizeof(SpriteInstance));
+
+	uint64_t drawnVertices = 0; //In the last batch, without the discarded ones.
+	for(size_t i = 0; i < count; ++i)
+	{
+		const SpriteInstance &sprite = instances[i];
+		if(!batches.empty())
+		{
+			Batch &last = batches.back();
+			const SpriteInstance &first = instances[last.firstInstance];
+			uint32_t vertexCount = std::max(last.vertexCount, sprite.vertexCount);
+			uint64_t drawn = drawnVertices + sprite.vertexCount;
+			if(first.shaderType == sprite.shaderType && first.textureIndex == sprite.textureIndex &&
+				(uint64_t)vertexCount*(last.instanceCount + 1) <= drawn*2)
+			{
+				last.vertexCount = vertexCount;
+				++last.instanceCount;
+				drawnVertices = drawn;
+				continue;
+			}
+		}
+		batches.push_back({sprite.vertexCount, (uint32_t)i, 1});
+		drawnVertices = sprite.vertexCount;
+	}
+
+	instances.clear();
+	return batches;
+}
@@ -0,0 +1,60 @@
+#ifndef SPRITE_BATCH_H_GUARD
+#define SPRITE_BATCH_H_GUARD
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm/mat4x4.hpp>
+#include <glm/vec4.hpp>
+
+//Per sprite data read by sprite.vert. Matches the std430 layout of SpriteInstance there.
+struct SpriteInstance
+{
+	glm::mat4 transform;
+	glm::vec4 mulColor;
+	int32_t shaderType;
+	int32_t textureIndex;
+	int32_t paletteSlot;
+	int32_t paletteIndex;
+	uint32_t firstVertex; //The mesh, pulled from the vertex buffer by the shader.
+	uint32_t vertexCount;
+	uint32_t padding[2];
+};
+static_assert(sizeof(SpriteInstance) == 112);
+
+//Vertex range of a sprite in the vertex buffer.
+struct SpriteMesh
+{
+	uint32_t firstVertex;
+	uint32_t vertexCount;
+};
+
+//Collects the sprites drawn in a frame and turns them into instanced draws.
+//Sprites are blended in the order they are added, so it's kept. Consecutive sprites with the same
+//shader type and texture share a draw even if their meshes differ: each instance carries its vertex range,
+//and the vertices past the end of a smaller mesh are discarded. Doesn't touch the GPU.
+class SpriteBatch
+{
+public:
+	struct Batch
+	{
+		uint32_t vertexCount; //Of the biggest mesh in the batch. Draw from vertex 0.
+		uint32_t firstInstance;
+		uint32_t instanceCount;
+	};
+
+	void Add(const SpriteMesh &mesh, SpriteInstance instance);
+	bool Empty() const { return instances.empty(); }
+	size_t Size() const { return instances.size(); }
+
+	//Copies up to capacity instances to out and returns the draws for them. Clears the batch.
+	//firstInstance counts from the start of out. Sprites past capacity are dropped.
+	//A batch is split rather than let the discarded vertices outnumber the drawn ones.
+	const std::vector<Batch> &Build(SpriteInstance *out, size_t capacity);
+
+private:
+	std::vector<SpriteInstance> instances;
+	std::vector<Batch> batches;
+};
+
+#endif /* SPRITE_BATCH_H_GUARD */
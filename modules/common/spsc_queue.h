@@ -0,0 +1,41 @@
+#ifndef SPSC_QUEUE_H_GUARD
+#define SPSC_QUEUE_H_GUARD
+
+#include <atomic>
+#include <cstddef>
+
+//Fixed size ring for one producer thread and one consumer thread. Neither side locks or waits.
+template<typename T, size_t capacity>
+class SpscQueue
+{
+	static_assert((capacity & (capacity - 1)) == 0, "Capacity must be a power of two.");
+public:
+	//Producer side. Returns false and drops the value if the queue is full.
+	bool Push(const T &value)
+	{
+		size_t tail = this->tail.load(std::memory_order_relaxed);
+		if(tail - head.load(std::memory_order_acquire) == capacity)
+			return false;
+		slots[tail & (capacity - 1)] = value;
+		this->tail.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	//Consumer side. Returns false if there's nothing to take.
+	bool Pop(T &value)
+	{
+		size_t head = this->head.load(std::memory_order_relaxed);
+		if(head == tail.load(std::memory_order_acquire))
+			return false;
+		value = slots[head & (capacity - 1)];
+		this->head.store(head + 1, std::memory_order_release);
+		return true;
+	}
+
+private:
+	T slots[capacity];
+	alignas(64) std::atomic<size_t> head = 0; //Next to pop.
+	alignas(64) std::atomic<size_t> tail = 0; //Next to push.
+};
+
+#endif /* SPSC_QUEUE_H_GUARD */
@@ -0,0 +1,118 @@
+#include "trace.h"
+
+#ifdef AFGE_TRACE
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <vector>
+
+namespace
+{
+	struct Event
+	{
+		const char *name;
+		std::string detail;
+		int tid;
+		int64_t start;
+		int64_t duration;
+	};
+
+	struct ThreadName
+	{
+		int tid;
+		std::string name;
+	};
+
+	const auto epoch = std::chrono::steady_clock::now();
+	std::atomic<int> nextTid = 0;
+	thread_local int tid = nextTid++;
+
+	std::mutex mutex;
+	std::vector<Event> events;
+	std::vector<ThreadName> threadNames;
+
+	int64_t Now()
+	{
+		return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - epoch).count();
+	}
+
+	void WriteString(std::ostream &out, const std::string &str)
+	{
+		out << '"';
+		for(char c : str)
+		{
+			if(c == '"' || c == '\\')
+				out << '\\' << c;
+			else if((unsigned char)c < 0x20)
+				out << ' ';
+			else
+				out << c;
+		}
+		out << '"';
+	}
+}
+
+namespace trace
+{
+
+Zone::Zone(const char *name, std::string detail):
+name(name), detail(std::move(detail)), start(Now())
+{}
+
+Zone::~Zone()
+{
+	auto end = Now();
+	std::lock_guard lock(mutex);
+	events.push_back({name, std::move(detail), tid, start, end - start});
+}
+
+void NameThread(const char *name)
+{
+	std::lock_guard lock(mutex);
+	threadNames.push_back({tid, name});
+}
+
+bool Write(const std::filesystem::path &file)
+{
+	std::ofstream out(file);
+	if(!out.is_open())
+	{
+		std::cerr << "Can't write trace to " << file << "\n";
+		return false;
+	}
+
+	std::lock_guard lock(mutex);
+	out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+	bool first = true;
+	for(auto &thread : threadNames)
+	{
+		out << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << thread.tid << ",\"args\":{\"name\":";
+		WriteString(out, thread.name);
+		out << "}}";
+		first = false;
+	}
+	for(auto &event : events)
+	{
+		out << (first ? "" : ",\n") << "{\"name\":";
+		WriteString(out, event.name);
+		out << ",\"cat\":\"load\",\"ph\":\"X\",\"pid\":1,\"tid\":" << event.tid
+			<< ",\"ts\":" << event.start << ",\"dur\":" << event.duration;
+		if(!event.detail.empty())
+		{
+			out << ",\"args\":{\"file\":";
+			WriteString(out, event.detail);
+			out << "}";
+		}
+		out << "}";
+		first = false;
+	}
+	out << "\n]}\n";
+	return !out.fail();
+}
+
+}
+
+#endif /* AFGE_TRACE */
@@ -0,0 +1,50 @@
+#ifndef TRACE_H_GUARD
+#define TRACE_H_GUARD
+
+//Scoped timing zones that can be written out as Chrome trace events and opened in
+//chrome://tracing or Perfetto. Everything expands to nothing unless AFGE_TRACE is defined,
+//so the arguments aren't even evaluated in normal builds.
+#ifdef AFGE_TRACE
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+namespace trace
+{
+	//Records the time between construction and destruction on the calling thread.
+	class Zone
+	{
+	public:
+		Zone(const char *name, std::string detail = {});
+		~Zone();
+		Zone(const Zone&) = delete;
+		Zone& operator=(const Zone&) = delete;
+
+	private:
+		const char *name;
+		std::string detail;
+		int64_t start;
+	};
+
+	void NameThread(const char *name);
+	bool Write(const std::filesystem::path &file); //Writes every zone finished so far.
+}
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+#define TRACE_ZONE(name) trace::Zone TRACE_CONCAT(traceZone, __LINE__)(name)
+#define TRACE_ZONE_DETAIL(name, detail) trace::Zone TRACE_CONCAT(traceZone, __LINE__)(name, detail)
+#define TRACE_THREAD(name) trace::NameThread(name)
+#define TRACE_WRITE(file) trace::Write(file)
+
+#else
+
+#define TRACE_ZONE(name)
+#define TRACE_ZONE_DETAIL(name, detail)
+#define TRACE_THREAD(name)
+#define TRACE_WRITE(file)
+
+#endif /* AFGE_TRACE */
+
+#endif /* TRACE_H_GUARD */
@@ -0,0 +1,44 @@
+#ifndef TRIPLE_BUFFER_H_GUARD
+#define TRIPLE_BUFFER_H_GUARD
+
+#include <atomic>
+#include <cstdint>
+
+//Passes the latest value from one producer thread to one consumer thread without locks or waits.
+//The producer fills Back and publishes it. The consumer calls Update and reads Front, which stays untouched until its next Update.
+//Values the consumer didn't get to see are overwritten, and slots are reused, so fill every field that is read.
+template<typename T>
+class TripleBuffer
+{
+public:
+	//Producer side.
+	T &Back() { return slots[back]; }
+	//Returns true if the new Back holds a value the consumer never got, so it's still only the producer's.
+	bool Publish()
+	{
+		uint8_t old = middle.exchange(back | freshBit, std::memory_order_acq_rel);
+		back = old & indexMask;
+		return old & freshBit;
+	}
+
+	//Consumer side. Returns true if Front changed.
+	bool Update()
+	{
+		if(!(middle.load(std::memory_order_relaxed) & freshBit))
+			return false;
+		front = middle.exchange(front, std::memory_order_acq_rel) & indexMask;
+		return true;
+	}
+	const T &Front() const { return slots[front]; }
+
+private:
+	static constexpr uint8_t freshBit = 0x4;
+	static constexpr uint8_t indexMask = 0x3;
+
+	T slots[3];
+	uint8_t back = 0;
+	uint8_t front = 1;
+	std::atomic<uint8_t> middle = 2; //Index of the spare slot. Has freshBit set while it holds an unread value.
+};
+
+#endif /* TRIPLE_BUFFER_H_GUARD */
@@ -47,9 +47,9 @@ void VertexBuffer::UpdateBuffer(int which, void *src, size_t count, int index)
 	memcpy(dst+dataPointers[which].location*dataPointers[which].stride, src, count);
 }
 
-void VertexBuffer::Load()
+void VertexBuffer::Load(vk::BufferUsageFlags usage)
 {
-	buffer.Allocate(&renderer, totalSize, vk::BufferUsageFlagBits::eVertexBuffer | vk::BufferUsageFlagBits::eTransferDst, vma::MemoryUsage::eGpuOnly);
+	buffer.Allocate(&renderer, totalSize, usage | vk::BufferUsageFlagBits::eTransferDst, vma::MemoryUsage::eGpuOnly);
 	AllocatedBuffer stagingBuffer(&renderer, totalSize, vk::BufferUsageFlagBits::eTransferSrc, vma::MemoryUsage::eCpuOnly);
 	uint8_t *data = (uint8_t*)stagingBuffer.Map();
 	size_t where = 0;
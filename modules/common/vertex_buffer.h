@@ -35,7 +35,7 @@ public:
 	int Prepare(size_t size, unsigned int stride, void *ptr);
 	std::pair<size_t,size_t> Index(int which) const;
 	void UpdateBuffer(int which, void *data, size_t count = 0, int index = 0);
-	void Load(); //GPU only
+	void Load(vk::BufferUsageFlags usage = vk::BufferUsageFlagBits::eVertexBuffer); //GPU only
 	void LoadHostVisible(int copies = 1);
 };
 
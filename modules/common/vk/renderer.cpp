@@ -1,17 +1,20 @@
 #include "renderer.h"
+#include "texture_streamer.h"
 #include <VkBootstrap.h>
 #include <vulkan/vulkan_raii.hpp>
 #include <SDL_vulkan.h>
 #include <iostream>
 #include <image.h>
+#include <filesystem>
 #include <fstream>
 
 size_t Renderer::uniformBufferAlignment = 0;
 size_t Renderer::uniformBufferSizeLimit = 0;
 
-bool Renderer::Init(SDL_Window *window_, int syncMode)
+bool Renderer::Init(SDL_Window *window_, int syncMode, const std::filesystem::path &cacheFile)
 {
 	window = window_;
+	pipelineCacheFile = cacheFile;
 	vkb::InstanceBuilder ib;
 	#ifndef NDEBUG
 		ib.request_validation_layers();
@@ -112,12 +115,105 @@ bool Renderer::Init(SDL_Window *window_, int syncMode)
 	CreateCommandPool();
 	CreateDescriptorPools();
 	CreateSyncStructs();
+	CreatePipelineCache();
+	streamer = std::make_unique<TextureStreamer>(*this);
 	return true;
 }
 
 Renderer::~Renderer()
 {
+	if(!*device)
+		return;
 	device.waitIdle();
+	streamer.reset();
+	SavePipelineCache();
+}
+
+//Written before the driver's data. The driver checks its own header too, but some don't check it well enough.
+struct PipelineCacheHeader
+{
+	uint32_t magic;
+	uint32_t vendorID;
+	uint32_t deviceID;
+	uint32_t driverVersion;
+	uint8_t uuid[VK_UUID_SIZE];
+	uint64_t dataSize;
+};
+constexpr uint32_t pipelineCacheMagic = 0x43504641; //"AFPC"
+
+void Renderer::CreatePipelineCache()
+{
+	PipelineCacheHeader expected{
+		.magic = pipelineCacheMagic,
+		.vendorID = deviceProperties.vendorID,
+		.deviceID = deviceProperties.deviceID,
+		.driverVersion = deviceProperties.driverVersion,
+	};
+	memcpy(expected.uuid, deviceProperties.pipelineCacheUUID.data(), VK_UUID_SIZE);
+
+	std::vector<char> data;
+	std::ifstream file(pipelineCacheFile, std::ios_base::binary);
+	if(file.is_open())
+	{
+		std::error_code error;
+		uintmax_t fileSize = std::filesystem::file_size(pipelineCacheFile, error);
+		PipelineCacheHeader header{};
+		file.read((char*)&header, sizeof(header));
+		//A damaged file can still have a matching header, so the size isn't trusted past what's actually there.
+		if(file && !error && header.dataSize <= fileSize - sizeof(header) &&
+			header.magic == expected.magic && header.vendorID == expected.vendorID &&
+			header.deviceID == expected.deviceID && header.driverVersion == expected.driverVersion &&
+			memcmp(header.uuid, expected.uuid, VK_UUID_SIZE) == 0)
+		{
+			data.resize(header.dataSize);
+			file.read(data.data(), data.size());
+			if(!file)
+				data.clear();
+		}
+		if(data.empty())
+			std::cerr << pipelineCacheFile << " is invalid or from another device or driver. Ignoring it.\n";
+	}
+
+	pipelineCache = {device, vk::PipelineCacheCreateInfo{
+		.initialDataSize = data.size(),
+		.pInitialData = data.data(),
+	}};
+}
+
+void Renderer::SavePipelineCache()
+{
+	if(!*pipelineCache)
+		return;
+
+	auto data = pipelineCache.getData();
+	PipelineCacheHeader header{
+		.magic = pipelineCacheMagic,
+		.vendorID = deviceProperties.vendorID,
+		.deviceID = deviceProperties.deviceID,
+		.driverVersion = deviceProperties.driverVersion,
+		.dataSize = data.size(),
+	};
+	memcpy(header.uuid, deviceProperties.pipelineCacheUUID.data(), VK_UUID_SIZE);
+
+	//Written aside and renamed so a crash can't leave half a file behind.
+	auto temp = pipelineCacheFile;
+	temp += ".tmp";
+	{
+		std::ofstream file(temp, std::ios_base::binary);
+		if(!file.is_open())
+		{
+			std::cerr << "Can't write " << temp << "\n";
+			return;
+		}
+		file.write((char*)&header, sizeof(header));
+		file.write((char*)data.data(), data.size());
+		if(!file)
+			return;
+	}
+	std::error_code ec;
+	std::filesystem::rename(temp, pipelineCacheFile, ec);
+	if(ec)
+		std::cerr << "Can't write " << pipelineCacheFile << ": " << ec.message() << "\n";
 }
 
 void Renderer::CreateSwapchain()
@@ -343,6 +439,7 @@ void Renderer::CreateDescriptorPools()
 		{vk::DescriptorType::eUniformBuffer, 10},
 		{vk::DescriptorType::eUniformBufferDynamic, 10 },
 		{vk::DescriptorType::eStorageBuffer, 10 },
+		{vk::DescriptorType::eStorageBufferDynamic, 10 },
 		{vk::DescriptorType::eCombinedImageSampler, 10 }
 	};
 	vk::DescriptorPoolCreateInfo pool_info = {
@@ -400,6 +497,7 @@ bool Renderer::Acquire()
 	const auto &inFlightFence = *frames[currentFrame].inFlightFence;
 	const auto &imageAvailableSemaphore = *frames[currentFrame].imageAvailableSemaphore;
 
+	streamer->Pump();
 	if(!shouldDraw)
 		return false;
 	if(device.waitForFences(inFlightFence, VK_TRUE, UINT64_MAX) == vk::Result::eTimeout)
@@ -575,18 +673,24 @@ Renderer::Texture Renderer::LoadAllocateTexture(const LoadTextureInfo& info, All
 	}
 	
 	stagingBuffer.Unmap();
-	vk::Extent3D extent = {image.width, image.height, 1};
-	vk::Format format;
-	if(image.compressed)
-		format = vk::Format::eBc3SrgbBlock;
-	else if(image.bytesPerPixel == 1)
-		format = vk::Format::eR8Uint;
-	else if(image.bytesPerPixel == 4)
-		format = vk::Format::eR8G8B8A8Srgb;
-	else
-		assert(0 && "Unsupported format: ");
+	auto format = GetTextureFormat(image.compressed, image.bytesPerPixel);
+	assert(format != vk::Format::eUndefined && "Unsupported format");
+	return CreateTexture({image.width, image.height, 1}, format);
+}
 
+vk::Format Renderer::GetTextureFormat(bool compressed, int bytesPerPixel)
+{
+	if(compressed)
+		return vk::Format::eBc3SrgbBlock;
+	else if(bytesPerPixel == 1)
+		return vk::Format::eR8Uint;
+	else if(bytesPerPixel == 4)
+		return vk::Format::eR8G8B8A8Srgb;
+	return vk::Format::eUndefined;
+}
 
+Renderer::Texture Renderer::CreateTexture(vk::Extent3D extent, vk::Format format)
+{
 	vk::ImageCreateInfo imgInfo =
 	{
 		.imageType = vk::ImageType::e2D,
@@ -622,7 +726,7 @@ Renderer::Texture Renderer::LoadAllocateTexture(const LoadTextureInfo& info, All
 	};
 }
 
-void Renderer::UploadTextures(const vk::CommandBuffer &cmd, vk::Buffer *buffers, Texture **textures, size_t amount)
+void Renderer::UploadTextures(const vk::CommandBuffer &cmd, vk::Buffer *buffers, Texture **textures, size_t amount, const vk::DeviceSize *offsets)
 {
 	std::vector<vk::ImageMemoryBarrier> barriers;
 	barriers.reserve(amount);
@@ -652,6 +756,7 @@ void Renderer::UploadTextures(const vk::CommandBuffer &cmd, vk::Buffer *buffers,
 	{
 		const auto &texture = *textures[i];
 		vk::BufferImageCopy copyRegion = {
+			.bufferOffset = offsets ? offsets[i] : 0,
 			.imageSubresource{
 				.aspectMask = vk::ImageAspectFlagBits::eColor,
 				.mipLevel = 0,
@@ -683,25 +788,23 @@ void Renderer::UploadTextures(const vk::CommandBuffer &cmd, vk::Buffer *buffers,
 
 void Renderer::LoadTextures(const std::vector<LoadTextureInfo>& infos, std::vector<Texture> &textures)
 {
-	const auto amount = infos.size();
-	std::vector<int> returns(amount);
-
-	if(amount > stagingBuffers.size())
-		stagingBuffers.resize(amount);
-	textures.reserve(textures.size()+amount);
+	auto load = LoadTexturesAsync(infos);
+	WaitTextures(*load);
+	if(load->Failed())
+		throw std::runtime_error("Texture can't be loaded");
 
-	std::vector<Texture*> textureRef(amount);
-	std::vector<vk::Buffer> bufferRef(amount);
+	auto loaded = load->Take();
+	textures.insert(textures.end(), std::make_move_iterator(loaded.begin()), std::make_move_iterator(loaded.end()));
+}
 
-	for(int i = 0; i < amount; ++i)
-	{
-		textures.push_back(LoadAllocateTexture(infos[i], stagingBuffers[i]));
-		textureRef[i] = &textures.back();
-		bufferRef[i] = stagingBuffers[i].buffer;
-	}
+std::shared_ptr<TextureLoad> Renderer::LoadTexturesAsync(std::vector<LoadTextureInfo> infos)
+{
+	return streamer->Load(std::move(infos));
+}
 
-	auto f = std::bind(&Renderer::UploadTextures, std::placeholders::_1, bufferRef.data(), textureRef.data(), amount);
-	ExecuteCommand(f);
+void Renderer::WaitTextures(const TextureLoad &load)
+{
+	streamer->Wait(load);
 }
 
 void Renderer::ExecuteCommand(std::function<void(vk::CommandBuffer)>&& function)
@@ -740,7 +843,7 @@ PipelineBuilder Renderer::GetPipelineBuilder()
 
 vk::raii::Pipeline Renderer::RegisterPipelines(const vk::GraphicsPipelineCreateInfo& pipelineInfo)
 {
-	return {device, nullptr, pipelineInfo};
+	return {device, pipelineCache, pipelineInfo};
 }
 
 std::pair<vk::raii::Pipeline, vk::raii::PipelineLayout> Renderer::RegisterPipelines(vk::GraphicsPipelineCreateInfo& pipelineInfo, const vk::PipelineLayoutCreateInfo& pipelineLayoutInfo)
@@ -749,7 +852,7 @@ std::pair<vk::raii::Pipeline, vk::raii::PipelineLayout> Renderer::RegisterPipeli
 	pipelineInfo.layout = *layout;
 	pipelineInfo.renderPass = *renderPass;
 	//pipelineInfo.basePipelineHandle = lastPipeline;
-	vk::raii::Pipeline graphicsPipeline = {device, nullptr, pipelineInfo};
+	vk::raii::Pipeline graphicsPipeline = {device, pipelineCache, pipelineInfo};
 	//lastPipeline = *graphicsPipeline;
 
 	return {std::move(graphicsPipeline), std::move(layout)};
@@ -765,12 +868,13 @@ std::vector<vk::DescriptorSet> Renderer::CreateDescriptorSets(const std::vector<
 	return (*device).allocateDescriptorSets(setAllocInfo);
 }
 
-const vk::CommandBuffer *Renderer::GetCommand()
+const vk::CommandBuffer *Renderer::GetCommand(int layer)
 {
+	assert(layer >= 0 && layer < externalDrawThreads);
 	if(!shouldDraw)
 		return nullptr;
 	else
-		return &*secondaryCmds[0][currentFrame];
+		return &*secondaryCmds[layer][currentFrame];
 }
 
 void Renderer::Wait()
@@ -824,7 +928,7 @@ Renderer::ImguiInfo Renderer::GetImguiInfo()
 		.Device = *device,
 		.QueueFamily = indices.graphics,
 		.Queue = qGraphics,
-		.PipelineCache = VK_NULL_HANDLE,
+		.PipelineCache = *pipelineCache,
 		.DescriptorPool = *descriptorPool,
 		.Subpass = 0,
 		.MinImageCount = bufferedFrames,
@@ -9,15 +9,20 @@
 #include <unordered_map>
 #include <SDL.h>
 #include <filesystem>
+#include <memory>
 
 
+class TextureStreamer;
+class TextureLoad;
+
 constexpr int internalWidth = 480;
 constexpr int internalHeight = 270;
 
 class Renderer
 {
-	static constexpr int externalDrawThreads = 1;
 public:
+	//Secondary command buffers per frame, executed in this order. Each one can be recorded from a different thread.
+	static constexpr int externalDrawThreads = 4;
 	static constexpr size_t bufferedFrames = 2;
 	static size_t uniformBufferAlignment;
 	static size_t uniformBufferSizeLimit;
@@ -95,6 +100,9 @@ private:
 
 	vk::raii::DescriptorPool descriptorPool = nullptr;
 
+	vk::raii::PipelineCache pipelineCache = nullptr;
+	std::filesystem::path pipelineCacheFile;
+
 	vk::raii::CommandPool commandPool {nullptr};
 	std::vector<vk::raii::CommandBuffer> cmds;
 
@@ -121,7 +129,8 @@ private:
 	std::array<float,4> clearColor;
 
 	//Texture upload
-	std::vector<AllocatedBuffer> stagingBuffers;
+	friend class TextureStreamer;
+	std::unique_ptr<TextureStreamer> streamer;
 
 private:
 	void RecreateSwapchain();
@@ -131,16 +140,22 @@ private:
 	void CreateCommandPool();
 	void CreateDescriptorPools();
 	void CreateSyncStructs();
+	void CreatePipelineCache();
+	void SavePipelineCache();
 	void BeginDrawing(int imageIndex);
 	void EndDrawing(int imageIndex);
 
-	static void UploadTextures(const vk::CommandBuffer &cmd, vk::Buffer *buffers, Texture **textures, size_t amount);
+	//Offsets into each buffer are 0 if not given.
+	static void UploadTextures(const vk::CommandBuffer &cmd, vk::Buffer *buffers, Texture **textures, size_t amount, const vk::DeviceSize *offsets = nullptr);
 	Renderer::Texture LoadAllocateTexture(const LoadTextureInfo& info, AllocatedBuffer &stagingBuffer);
+	Renderer::Texture CreateTexture(vk::Extent3D extent, vk::Format format);
+	static vk::Format GetTextureFormat(bool compressed, int bytesPerPixel); //eUndefined if unsupported.
 
 public:
 	//Renderer();
 	~Renderer();
-	bool Init(SDL_Window *, int syncMode);
+	//The pipeline cache is read from and written back to cacheFile.
+	bool Init(SDL_Window *, int syncMode, const std::filesystem::path &cacheFile = "pipeline.cache");
 	
 	void ExecuteCommand(std::function<void(vk::CommandBuffer)>&& function);
 
@@ -152,6 +167,9 @@ public:
 	
 	Renderer::Texture LoadTextureSingle(const LoadTextureInfo& info);
 	void LoadTextures(const std::vector<LoadTextureInfo>& infos, std::vector<Texture> &textures);
+	//Decodes in the background and uploads from Acquire, so the caller can keep drawing. Poll the returned handle.
+	std::shared_ptr<TextureLoad> LoadTexturesAsync(std::vector<LoadTextureInfo> infos);
+	void WaitTextures(const TextureLoad &load); //Blocks, but keeps uploads going.
 	void TransferBuffer(AllocatedBuffer &src, AllocatedBuffer &dst, size_t size);
 	PipelineBuilder GetPipelineBuilder();
 
@@ -161,7 +179,7 @@ public:
 	vk::raii::Sampler CreateSampler(vk::Filter mag = vk::Filter::eNearest, /* vk::Filter min = vk::Filter::eNearest, */ 
 		vk::SamplerAddressMode mode = vk::SamplerAddressMode::eRepeat);
 
-	const vk::CommandBuffer *GetCommand();
+	const vk::CommandBuffer *GetCommand(int layer = 0);
 	
 	const vma::AllocatorEx &GetAllocator() const{return allocator;}
 	const size_t CurrentFrame() const{return currentFrame;}
@@ -0,0 +1,237 @@
+#include "texture_streamer.h"
+#include <image.h>
+#include <trace.h>
+#include <iostream>
+#include <cstring>
+
+TextureStreamer::TextureStreamer(Renderer &renderer, unsigned threadCount):
+renderer(renderer)
+{
+	auto &device = renderer.device;
+	pool = {device, {
+		.flags = vk::CommandPoolCreateFlagBits::eResetCommandBuffer,
+		.queueFamilyIndex = renderer.indices.graphics,
+	}};
+
+	vk::CommandBufferAllocateInfo allocInfo{
+		.commandPool = *pool,
+		.level = vk::CommandBufferLevel::ePrimary,
+		.commandBufferCount = slotCount,
+	};
+	vk::raii::CommandBuffers cmds(device, allocInfo);
+	for(int i = 0; i < slotCount; ++i)
+	{
+		slots[i].cmd = std::move(cmds[i]);
+		slots[i].fence = {device, vk::FenceCreateInfo{}};
+	}
+
+	ring.Allocate(&renderer, slotSize*slotCount, vk::BufferUsageFlagBits::eTransferSrc, vma::MemoryUsage::eCpuOnly);
+	ringData = (uint8_t*)ring.Map();
+
+	for(unsigned i = 0; i < threadCount; ++i)
+		threads.emplace_back(&TextureStreamer::Work, this);
+}
+
+TextureStreamer::~TextureStreamer()
+{
+	{
+		std::lock_guard lock(mutex);
+		quit = true;
+	}
+	wake.notify_all();
+	for(auto &thread : threads)
+		thread.join();
+
+	for(auto &slot : slots)
+	{
+		if(slot.busy)
+		{
+			(void)(*renderer.device).waitForFences(*slot.fence, VK_TRUE, UINT64_MAX);
+			Retire(slot);
+		}
+	}
+}
+
+std::shared_ptr<TextureLoad> TextureStreamer::Load(std::vector<Renderer::LoadTextureInfo> infos)
+{
+	auto load = std::make_shared<TextureLoad>();
+	load->textures.resize(infos.size());
+	load->remaining = infos.size();
+
+	{
+		std::lock_guard lock(mutex);
+		for(size_t i = 0; i < infos.size(); ++i)
+		{
+			Job job{load, i, std::move(infos[i])};
+			if(job.info.type == Renderer::palette)
+			{
+				job.paletteData.assign(job.info.data, job.info.data + job.info.width*job.info.height*4);
+				job.info.data = nullptr;
+			}
+			jobs.push_back(std::move(job));
+		}
+	}
+	wake.notify_all();
+	return load;
+}
+
+void TextureStreamer::Work()
+{
+	TRACE_THREAD("Texture decoder");
+	while(true)
+	{
+		Job job;
+		{
+			std::unique_lock lock(mutex);
+			wake.wait(lock, [this]{return quit || !jobs.empty();});
+			if(quit)
+				return;
+			job = std::move(jobs.front());
+			jobs.pop_front();
+		}
+		Decode(job);
+	}
+}
+
+void TextureStreamer::Decode(Job &job)
+{
+	TRACE_ZONE_DETAIL("Decode texture", job.info.path.generic_string());
+	std::unique_ptr<ImageData> image;
+	bool result;
+	if(job.info.type == Renderer::palette)
+	{
+		image = std::make_unique<ImageData>(job.info.width, job.info.height, 4);
+		memcpy(image->data, job.paletteData.data(), job.paletteData.size());
+		result = true;
+	}
+	else
+	{
+		image = std::make_unique<ImageData>();
+		result = image->LoadAny(job.info.path);
+	}
+
+	auto format = result ? Renderer::GetTextureFormat(image->compressed, image->bytesPerPixel) : vk::Format::eUndefined;
+	if(format == vk::Format::eUndefined)
+	{
+		std::cerr << "Error while loading " << job.info.path <<"\n";
+		job.load->failed = true;
+		job.load->remaining.fetch_sub(1, std::memory_order_release);
+		return;
+	}
+
+	//Creating images is thread safe, only the upload has to wait for Pump.
+	job.load->textures[job.index] = renderer.CreateTexture({image->width, image->height, 1}, format);
+	{
+		std::lock_guard lock(mutex);
+		decoded.push_back({std::move(job.load), job.index, std::move(image)});
+	}
+	decodedSignal.notify_all();
+}
+
+void TextureStreamer::Retire(Slot &slot)
+{
+	for(auto &load : slot.loads)
+		load->remaining.fetch_sub(1, std::memory_order_release);
+	slot.loads.clear();
+	slot.oversized.Destroy();
+	renderer.device.resetFences(*slot.fence);
+	slot.busy = false;
+}
+
+void TextureStreamer::Fill(Slot &slot, vk::DeviceSize ringOffset)
+{
+	std::vector<Decoded> batch;
+	std::vector<vk::DeviceSize> offsets;
+	vk::DeviceSize used = 0;
+	{
+		std::lock_guard lock(mutex);
+		while(!decoded.empty())
+		{
+			vk::DeviceSize size = decoded.front().image->GetMemSize();
+			vk::DeviceSize start = (used + 15) & ~vk::DeviceSize(15); //Multiple of the biggest texel block.
+			if(start + size > slotSize && !batch.empty())
+				break;
+			batch.push_back(std::move(decoded.front()));
+			decoded.pop_front();
+			offsets.push_back(start);
+			used = start + size;
+			if(used > slotSize) //Doesn't fit in a slot at all. Goes alone.
+				break;
+		}
+	}
+	if(batch.empty())
+		return;
+	TRACE_ZONE("Upload textures");
+
+	std::vector<vk::Buffer> buffers(batch.size(), ring.buffer);
+	std::vector<Renderer::Texture*> textures(batch.size());
+	if(used > slotSize)
+	{
+		slot.oversized.Allocate(&renderer, used, vk::BufferUsageFlagBits::eTransferSrc, vma::MemoryUsage::eCpuOnly);
+		memcpy(slot.oversized.Map(), batch[0].image->data, used);
+		slot.oversized.Unmap();
+		buffers[0] = slot.oversized.buffer;
+	}
+	else
+	{
+		for(size_t i = 0; i < batch.size(); ++i)
+		{
+			memcpy(ringData + ringOffset + offsets[i], batch[i].image->data, batch[i].image->GetMemSize());
+			offsets[i] += ringOffset;
+		}
+	}
+
+	for(size_t i = 0; i < batch.size(); ++i)
+	{
+		textures[i] = &batch[i].load->textures[batch[i].index];
+		slot.loads.push_back(std::move(batch[i].load));
+	}
+
+	auto &cmd = *slot.cmd;
+	cmd.begin({.flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit});
+	Renderer::UploadTextures(cmd, buffers.data(), textures.data(), batch.size(), offsets.data());
+	cmd.end();
+
+	vk::SubmitInfo submitInfo{
+		.commandBufferCount = 1,
+		.pCommandBuffers = &cmd,
+	};
+	renderer.qGraphics.submit(submitInfo, *slot.fence);
+	slot.busy = true;
+}
+
+void TextureStreamer::Pump()
+{
+	for(int i = 0; i < slotCount; ++i)
+	{
+		auto &slot = slots[i];
+		if(slot.busy && (*renderer.device).getFenceStatus(*slot.fence) == vk::Result::eSuccess)
+			Retire(slot);
+		if(!slot.busy)
+			Fill(slot, slotSize*i);
+	}
+}
+
+void TextureStreamer::Wait(const TextureLoad &load)
+{
+	while(!load.Ready())
+	{
+		Pump();
+		if(load.Ready())
+			break;
+
+		std::vector<vk::Fence> inFlight;
+		for(auto &slot : slots)
+		{
+			if(slot.busy)
+				inFlight.push_back(*slot.fence);
+		}
+		if(!inFlight.empty())
+			(void)(*renderer.device).waitForFences(inFlight, VK_FALSE, 1000000);
+		else
+		{
+			std::unique_lock lock(mutex);
+			decodedSignal.wait_for(lock, std::chrono::milliseconds(1), [this]{return !decoded.empty();});
+		}
+	}
+}
@@ -0,0 +1,92 @@
+#ifndef TEXTURE_STREAMER_H_GUARD
+#define TEXTURE_STREAMER_H_GUARD
+
+#include "renderer.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct ImageData;
+
+//Textures requested with Renderer::LoadTexturesAsync. They can be taken once Ready() is true.
+class TextureLoad
+{
+public:
+	bool Ready() const { return remaining.load(std::memory_order_acquire) == 0; }
+	bool Failed() const { return failed.load(); } //Some texture couldn't be decoded. Its slot is left empty.
+	size_t Size() const { return textures.size(); }
+	//Same order as the infos they were requested with. Only valid once.
+	std::vector<Renderer::Texture> Take() { return std::move(textures); }
+
+private:
+	friend class TextureStreamer;
+	std::vector<Renderer::Texture> textures;
+	std::atomic<size_t> remaining = 0;
+	std::atomic<bool> failed = false;
+};
+
+//Decodes images on its own threads and uploads them through a fixed staging ring.
+//Each slot of the ring has a command buffer and a fence. Pump() reuses the slots whose fence signaled.
+class TextureStreamer
+{
+public:
+	static constexpr int slotCount = 4;
+	static constexpr vk::DeviceSize slotSize = 16 << 20; //Bigger images get a staging buffer of their own.
+
+	TextureStreamer(Renderer &renderer, unsigned threadCount = std::max(std::thread::hardware_concurrency()/2, 1u));
+	~TextureStreamer(); //Waits for everything in flight.
+
+	std::shared_ptr<TextureLoad> Load(std::vector<Renderer::LoadTextureInfo> infos);
+	//Must be called from the thread that submits to the graphics queue.
+	void Pump();
+	void Wait(const TextureLoad &load);
+
+private:
+	struct Job
+	{
+		std::shared_ptr<TextureLoad> load;
+		size_t index;
+		Renderer::LoadTextureInfo info;
+		std::vector<uint8_t> paletteData; //Owned copy, since the caller's may be gone by the time it's decoded.
+	};
+	struct Decoded
+	{
+		std::shared_ptr<TextureLoad> load;
+		size_t index;
+		std::unique_ptr<ImageData> image;
+	};
+	struct Slot
+	{
+		vk::raii::CommandBuffer cmd = nullptr;
+		vk::raii::Fence fence = nullptr;
+		std::vector<std::shared_ptr<TextureLoad>> loads; //One entry per texture in flight.
+		AllocatedBuffer oversized;
+		bool busy = false;
+	};
+
+	Renderer &renderer;
+	vk::raii::CommandPool pool = nullptr;
+	AllocatedBuffer ring;
+	uint8_t *ringData = nullptr;
+	Slot slots[slotCount];
+
+	std::vector<std::thread> threads;
+	std::mutex mutex;
+	std::condition_variable wake;
+	std::condition_variable decodedSignal;
+	std::deque<Job> jobs;
+	std::deque<Decoded> decoded;
+	bool quit = false;
+
+	void Work();
+	void Decode(Job &job);
+	void Retire(Slot &slot);
+	void Fill(Slot &slot, vk::DeviceSize offset); //Takes decoded images that fit and submits them.
+};
+
+#endif /* TEXTURE_STREAMER_H_GUARD */
@@ -0,0 +1,72 @@
+#include "worker_pool.h"
+
+WorkerPool::WorkerPool(unsigned threadCount)
+{
+	threads.reserve(threadCount);
+	for(unsigned i = 0; i < threadCount; ++i)
+		threads.emplace_back(&WorkerPool::Work, this);
+}
+
+WorkerPool::~WorkerPool()
+{
+	{
+		std::lock_guard lock(mutex);
+		quit = true;
+	}
+	wake.notify_all();
+	for(auto &thread : threads)
+		thread.join();
+}
+
+void WorkerPool::ParallelFor(size_t count, const std::function<void(size_t)> &_job)
+{
+	if(threads.empty() || count <= 1)
+	{
+		for(size_t i = 0; i < count; ++i)
+			_job(i);
+		return;
+	}
+
+	{
+		std::lock_guard lock(mutex);
+		job = &_job;
+		jobCount = count;
+		nextJob = 0;
+		busy = threads.size();
+		++generation;
+	}
+	wake.notify_all();
+	RunJobs();
+
+	std::unique_lock lock(mutex);
+	done.wait(lock, [this]{return busy == 0;});
+	job = nullptr;
+}
+
+void WorkerPool::RunJobs()
+{
+	size_t i;
+	while((i = nextJob.fetch_add(1)) < jobCount)
+		(*job)(i);
+}
+
+void WorkerPool::Work()
+{
+	uint64_t seenGeneration = 0;
+	while(true)
+	{
+		{
+			std::unique_lock lock(mutex);
+			wake.wait(lock, [&]{return quit || generation != seenGeneration;});
+			if(quit)
+				return;
+			seenGeneration = generation;
+		}
+		RunJobs();
+		{
+			std::lock_guard lock(mutex);
+			if(--busy == 0)
+				done.notify_one();
+		}
+	}
+}
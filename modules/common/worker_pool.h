@@ -0,0 +1,45 @@
+#ifndef WORKER_POOL_H_GUARD
+#define WORKER_POOL_H_GUARD
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//Fixed set of threads that run batches of indexed jobs. The calling thread helps too.
+class WorkerPool
+{
+public:
+	//Defaults to one thread less than the hardware has, since the caller also works.
+	WorkerPool(unsigned threadCount = std::max(std::thread::hardware_concurrency(), 1u) - 1);
+	~WorkerPool();
+	WorkerPool(const WorkerPool&) = delete;
+	WorkerPool& operator=(const WorkerPool&) = delete;
+
+	//Calls job(i) for every i in [0, count) and returns once all of them are done.
+	//Jobs may run in any order and on any thread. Not reentrant.
+	void ParallelFor(size_t count, const std::function<void(size_t)> &job);
+	unsigned Size() const { return threads.size() + 1; }
+
+private:
+	std::vector<std::thread> threads;
+	std::mutex mutex;
+	std::condition_variable wake;
+	std::condition_variable done;
+
+	const std::function<void(size_t)> *job = nullptr;
+	size_t jobCount = 0;
+	std::atomic<size_t> nextJob = 0;
+	unsigned busy = 0;
+	uint64_t generation = 0;
+	bool quit = false;
+
+	void Work();
+	void RunJobs();
+};
+
+#endif /* WORKER_POOL_H_GUARD */
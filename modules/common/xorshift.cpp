@@ -18,4 +18,46 @@ int32_t XorShift32::Get()
 	x ^= x >> 17;
 	x ^= x << 5;
 	return (a = x);
-}
\ No newline at end of file
+}
+XorShift32 XorShift32::Fork(uint32_t stream) const
+{
+	//Murmur3 finalizer over the state and the stream index.
+	uint32_t x = a + 0x9E3779B9u*(stream+1);
+	x ^= x >> 16;
+	x *= 0x85EBCA6Bu;
+	x ^= x >> 13;
+	x *= 0xC2B2AE35u;
+	x ^= x >> 16;
+	return {x ? x : 1};
+}
+
+XorShift32x8::XorShift32x8(uint32_t seed)
+{
+	const XorShift32 base{seed};
+	for(uint32_t i = 0; i < 8; ++i)
+		lanes[i] = base.Fork(i).a;
+}
+
+void XorShift32x8::Fill(uint32_t *out, size_t n)
+{
+	size_t i = 0;
+	for(; i + 8 <= n; i += 8)
+	{
+		for(int l = 0; l < 8; ++l)
+		{
+			uint32_t x = lanes[l];
+			x ^= x << 13;
+			x ^= x >> 17;
+			x ^= x << 5;
+			out[i+l] = lanes[l] = x;
+		}
+	}
+	for(int l = 0; i < n; ++i, ++l)
+	{
+		uint32_t x = lanes[l];
+		x ^= x << 13;
+		x ^= x >> 17;
+		x ^= x << 5;
+		out[i] = lanes[l] = x;
+	}
+}
@@ -1,11 +1,21 @@
 #ifndef XORSHIFT_H_GUARD
 #define XORSHIFT_H_GUARD
+#include <cstddef>
 #include <cstdint>
 
 struct XorShift32{
 	uint32_t a = 1;
 	uint32_t GetU();
 	int32_t Get();
+	//Independent generator derived from the current state. Doesn't advance this one.
+	XorShift32 Fork(uint32_t stream) const;
+};
+
+//Eight interleaved generators so filling big arrays of random numbers vectorizes.
+struct XorShift32x8{
+	uint32_t lanes[8];
+	XorShift32x8(uint32_t seed);
+	void Fill(uint32_t *out, size_t n);
 };
 
 
@@ -2,217 +2,212 @@
 #define FIXEDPOINT_H_INCLUDED
 
 #include <cstdint> //fixed width types
+#include <limits>
+#include <type_traits>
 
 #ifndef FP_FRACBITS
 	#define FP_FRACBITS 16
 #endif
 
-	
-//Fixed point, 32bit as 16.16.
-class FixedPoint
-{
-	
-public:
-	typedef std::int32_t fixed_t;
-	fixed_t value;
-
-public:
-	constexpr FixedPoint();
-	constexpr FixedPoint(int decimal, unsigned int fractional);
-
+template<int FracBits, typename Storage, typename Intermediate, bool Saturate>
+class FixedPointT;
 
+template<typename T> struct IsFixedPoint : std::false_type {};
+template<int FracBits, typename Storage, typename Intermediate, bool Saturate>
+struct IsFixedPoint<FixedPointT<FracBits, Storage, Intermediate, Saturate>> : std::true_type {};
 
-	FixedPoint& operator=(FixedPoint a);
+//Fixed point number stored in Storage with FracBits fractional bits.
+//Multiplication and division go through Intermediate, which must be wide enough to hold value << FracBits.
+//When Saturate is set results are clamped to the range of Storage instead of wrapping around.
+//Everything is constexpr and lives in this header so it gets inlined into the physics code.
+template<int FracBits, typename Storage = std::int32_t, typename Intermediate = std::int64_t, bool Saturate = false>
+class FixedPointT
+{
+	template<int, typename, typename, bool> friend class FixedPointT;
 
-	FixedPoint operator+(FixedPoint a) const;
-	FixedPoint operator-(FixedPoint a) const;
-	void operator+=(FixedPoint a);
-	void operator-=(FixedPoint a);
+	static_assert(std::is_signed_v<Storage> && std::is_integral_v<Storage>);
+	static_assert(sizeof(Intermediate) >= sizeof(Storage));
+	static_assert(FracBits > 0 && FracBits < sizeof(Storage)*8);
 
-	FixedPoint operator/(FixedPoint a) const;
-	FixedPoint operator*(FixedPoint a) const;
+public:
+	typedef Storage fixed_t;
+	fixed_t value;
 
-	bool operator<(const FixedPoint &a) const;
-	bool operator<=(const FixedPoint &a) const;
-	bool operator>(const FixedPoint &a) const;
-	bool operator>=(const FixedPoint &a) const;
-	bool operator==(const FixedPoint &a) const;
-	bool operator!=(const FixedPoint &a) const;
+	static constexpr int fracBits = FracBits;
+	static constexpr Intermediate fracUnit = Intermediate(1) << FracBits;
 
-	FixedPoint operator-() const;
+public:
+	constexpr FixedPointT() : value(0) {}
+	constexpr FixedPointT(int decimal, unsigned int fractional);
+	template<typename T> requires (!IsFixedPoint<T>::value)
+	constexpr FixedPointT(T number) : value(ToFixed(number)) {}
+
+	//Between precisions. Explicit because it can lose bits or overflow.
+	template<int OtherBits, typename OtherStorage, typename OtherIntermediate, bool OtherSaturate>
+	explicit constexpr FixedPointT(FixedPointT<OtherBits, OtherStorage, OtherIntermediate, OtherSaturate> other) :
+	value(Rescale<OtherBits>(other.value)) {}
+
+	template<typename T> requires (!IsFixedPoint<T>::value)
+	constexpr FixedPointT& operator=(T a)
+	{
+		value = ToFixed(a);
+		return *this;
+	}
 
-	operator int() const;
-	operator float() const;
-	operator double() const;
+	//Arithmetic
+	constexpr FixedPointT operator+(FixedPointT a) const
+	{
+		return FromRaw(static_cast<Intermediate>(value) + a.value);
+	}
 
-	FixedPoint abs() const;
+	constexpr FixedPointT operator-(FixedPointT a) const
+	{
+		return FromRaw(static_cast<Intermediate>(value) - a.value);
+	}
 
-	template<typename T> constexpr FixedPoint(T number);
+	constexpr FixedPointT operator*(FixedPointT a) const
+	{
+		Intermediate mul = static_cast<Intermediate>(value) * static_cast<Intermediate>(a.value);
+		return FromRaw(mul >> FracBits);
+	}
 
-	template<typename T> constexpr FixedPoint& operator=(T a);
+	constexpr FixedPointT operator/(FixedPointT a) const
+	{
+		Intermediate div = static_cast<Intermediate>(value) << FracBits;
+		return FromRaw(div / a.value);
+	}
 
-	template<typename T> constexpr FixedPoint operator+(T a) const;
-	template<typename T> constexpr FixedPoint operator-(T a) const;
-	template<typename T> void operator+=(T a);
-	template<typename T> void operator-=(T a);
+	constexpr FixedPointT& operator+=(FixedPointT a) { return *this = *this + a; }
+	constexpr FixedPointT& operator-=(FixedPointT a) { return *this = *this - a; }
 
-	template<typename T> bool operator<(const T &a) const;
-	template<typename T> bool operator<=(const T &a) const;
-	template<typename T> bool operator>(const T &a) const;
-	template<typename T> bool operator>=(const T &a) const;
-	template<typename T> bool operator==(const T &a) const;
-	template<typename T> bool operator!=(const T &a) const;
+	constexpr FixedPointT operator-() const
+	{
+		return FromRaw(-static_cast<Intermediate>(value));
+	}
 
+	constexpr FixedPointT abs() const
+	{
+		return value < 0 ? -*this : *this;
+	}
 
-	template<typename T> constexpr FixedPoint operator/(T a) const;
-	template<typename T> constexpr FixedPoint operator*(T a) const;
+	template<typename T> constexpr FixedPointT operator+(T a) const { return *this + FixedPointT(a); }
+	template<typename T> constexpr FixedPointT operator-(T a) const { return *this - FixedPointT(a); }
+	template<typename T> constexpr FixedPointT operator*(T a) const { return *this * FixedPointT(a); }
+	template<typename T> constexpr FixedPointT operator/(T a) const { return *this / FixedPointT(a); }
+	template<typename T> constexpr FixedPointT& operator+=(T a) { return *this += FixedPointT(a); }
+	template<typename T> constexpr FixedPointT& operator-=(T a) { return *this -= FixedPointT(a); }
+
+	//Boolean operators
+	constexpr bool operator<(const FixedPointT &a) const { return value < a.value; }
+	constexpr bool operator<=(const FixedPointT &a) const { return value <= a.value; }
+	constexpr bool operator>(const FixedPointT &a) const { return value > a.value; }
+	constexpr bool operator>=(const FixedPointT &a) const { return value >= a.value; }
+	constexpr bool operator==(const FixedPointT &a) const { return value == a.value; }
+	constexpr bool operator!=(const FixedPointT &a) const { return value != a.value; }
+
+	template<typename T> constexpr bool operator<(const T &a) const { return *this < FixedPointT(a); }
+	template<typename T> constexpr bool operator<=(const T &a) const { return *this <= FixedPointT(a); }
+	template<typename T> constexpr bool operator>(const T &a) const { return *this > FixedPointT(a); }
+	template<typename T> constexpr bool operator>=(const T &a) const { return *this >= FixedPointT(a); }
+	template<typename T> constexpr bool operator==(const T &a) const { return *this == FixedPointT(a); }
+	template<typename T> constexpr bool operator!=(const T &a) const { return *this != FixedPointT(a); }
+
+	//Casting
+	constexpr operator int() const { return static_cast<int>(value >> FracBits); }
+	constexpr operator float() const { return static_cast<float>(value) / fracUnit; }
+	constexpr operator double() const { return static_cast<double>(value) / fracUnit; }
 
 private:
-	static constexpr int fracBits = FP_FRACBITS;
-	static constexpr int fracUnit = 1 << fracBits;
+	static constexpr Storage Narrow(Intermediate raw)
+	{
+		if constexpr(Saturate)
+		{
+			if(raw > std::numeric_limits<Storage>::max())
+				return std::numeric_limits<Storage>::max();
+			if(raw < std::numeric_limits<Storage>::min())
+				return std::numeric_limits<Storage>::min();
+		}
+		return static_cast<Storage>(raw);
+	}
 
-	static fixed_t ToFixed(double number);
-	static fixed_t ToFixed(float number);
-	static fixed_t ToFixed(int number);
-};
+	static constexpr FixedPointT FromRaw(Intermediate raw)
+	{
+		FixedPointT result;
+		result.value = Narrow(raw);
+		return result;
+	}
 
+	template<int OtherBits, typename T>
+	static constexpr fixed_t Rescale(T raw)
+	{
+		if constexpr(OtherBits <= FracBits)
+			return Narrow(static_cast<Intermediate>(raw) << (FracBits - OtherBits));
+		else
+			return Narrow(static_cast<Intermediate>(raw >> (OtherBits - FracBits)));
+	}
 
-constexpr FixedPoint::FixedPoint() : value(0)
-{
-	
-}
+	template<typename T>
+	static constexpr fixed_t ToFixed(T number)
+	{
+		if constexpr(std::is_floating_point_v<T>)
+		{
+			if constexpr(Saturate)
+			{
+				T scaled = number*fracUnit;
+				if(scaled >= static_cast<T>(std::numeric_limits<Storage>::max()))
+					return std::numeric_limits<Storage>::max();
+				if(scaled <= static_cast<T>(std::numeric_limits<Storage>::min()))
+					return std::numeric_limits<Storage>::min();
+				return static_cast<fixed_t>(scaled);
+			}
+			else
+				return static_cast<fixed_t>(number*fracUnit);
+		}
+		else
+			return Narrow(static_cast<Intermediate>(number) << FracBits);
+	}
+};
 
-constexpr FixedPoint::FixedPoint(int integral, unsigned int fractional) : value(0)
+template<int FracBits, typename Storage, typename Intermediate, bool Saturate>
+constexpr FixedPointT<FracBits, Storage, Intermediate, Saturate>::FixedPointT(int integral, unsigned int fractional) : value(0)
 {
-
 	bool negate = false;
 	if(integral < 0)
 	{
 		integral = -integral;
 		negate = true;
 	}
-	
+
 	//Set the integral part in the msb
-	integral <<= fracBits;
+	Intermediate integralFixed = static_cast<Intermediate>(integral) << FracBits;
 
 	//Make sure the fractional part fits in the lsb
 	int c = 0; //Compensation
 	while(fractional >= fracUnit)
-	{	
+	{
 		fractional >>= 1;
 		c++;
 	}
 
 	//Base 10 fractional to base 2
-	fractional <<= fracBits;
-	while(fractional >= 1 << (fracBits))
-	{	
-		fractional /= 10;
+	Intermediate fractionalFixed = static_cast<Intermediate>(fractional) << FracBits;
+	while(fractionalFixed >= fracUnit)
+	{
+		fractionalFixed /= 10;
 		if(c > 0)
 		{
-			fractional <<= 1;
+			fractionalFixed <<= 1;
 			c--;
 		}
 	}
 
-	value = integral + fractional;
-	if(negate)
-		value = -value;
+	Intermediate raw = integralFixed + fractionalFixed;
+	value = Narrow(negate ? -raw : raw);
 }
 
-template<typename T>
-constexpr FixedPoint::FixedPoint(T number)
-{
-	value = ToFixed(number);
-}
-
-template<typename T>
-constexpr FixedPoint& FixedPoint::operator=(T a)
-{
-	value = ToFixed(a);
-	return *this;
-}
-
-//Arithmetic
-
-template<typename T>
-constexpr FixedPoint FixedPoint::operator+(T a) const
-{
-	const FixedPoint operand(a);
-	return operator+(operand);
-}
-
-template<typename T>
-constexpr FixedPoint FixedPoint::operator-(T a) const
-{
-	const FixedPoint operand(a);
-	return operator-(operand);
-}
-
-template<typename T>
-constexpr FixedPoint FixedPoint::operator*(T a) const
-{
-	const FixedPoint operand(a);
-	return operator*(operand);
-}
-
-template<typename T>
-constexpr FixedPoint FixedPoint::operator/(T a) const
-{
-	const FixedPoint operand(a);
-	return operator/(operand);
-}
-
-template<typename T>
-void FixedPoint::operator+=(T a)
-{
-	const FixedPoint operand(a);
-	*this = (*this)+operand;
-}
-
-template<typename T>
-void FixedPoint::operator-=(T a)
-{
-	const FixedPoint operand(a);
-	*this = (*this)-operand;
-}
-
-//Boolean operator
-
-template<typename T>
-bool FixedPoint::operator<(const T &a) const
-{
-	return *this < FixedPoint(a);
-}
-
-template<typename T>
-bool FixedPoint::operator<=(const T &a) const
-{
-	return *this <= FixedPoint(a);
-}
-
-template<typename T>
-bool FixedPoint::operator>(const T &a) const
-{
-	return *this > FixedPoint(a);
-}
-
-template<typename T>
-bool FixedPoint::operator>=(const T &a) const
-{
-	return *this >= FixedPoint(a);
-}
-
-template<typename T>
-bool FixedPoint::operator==(const T &a) const
-{
-	return *this == FixedPoint(a);
-}
-
-template<typename T>
-bool FixedPoint::operator!=(const T &a) const
-{
-	return *this != FixedPoint(a);
-}
+//Fixed point, 32bit as 16.16 by default.
+typedef FixedPointT<FP_FRACBITS> FixedPoint;
+//Same layout as FixedPoint, but clamps instead of overflowing.
+typedef FixedPointT<FP_FRACBITS, std::int32_t, std::int64_t, true> FixedPointSat;
 
 #endif //FIXEDPOINT_H_INCLUDED
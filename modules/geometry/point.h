@@ -12,10 +12,9 @@ public:
 	
 public:
 	Point2d();
-	Point2d(const Point2d& p);
+	Point2d(const Point2d& p) = default;
 	Point2d(T _x, T _y);
 
-	Point2d& operator=(Point2d a);
 	Point2d operator+(Point2d a);
 	Point2d operator-(Point2d a);
 	Point2d& operator+=(Point2d a);
@@ -28,13 +27,6 @@ Point2d<T>::Point2d()
 
 }
 
-template <class T>
-Point2d<T>::Point2d(const Point2d<T>& p) : Point2d()
-{
-	x = p.x;
-	y = p.y;
-}
-
 template <class T>
 Point2d<T>::Point2d(T _x, T _y): Point2d()
 {
@@ -42,14 +34,6 @@ Point2d<T>::Point2d(T _x, T _y): Point2d()
 	y = _y;
 }
 
-template <class T>
-Point2d<T>& Point2d<T>::operator=(Point2d<T> a)
-{
-	x = a.x;
-	y = a.y;
-	return *this;
-}
-
 template <class T>
 Point2d<T> Point2d<T>::operator+(Point2d<T> op)
 {
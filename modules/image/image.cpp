@@ -1,6 +1,8 @@
 #include "image.h"
+#include <vfs.h>
 #include <spng.h>
 #include <cassert>
+#include <cstring>
 #include <iostream>
 #include <fstream>
 #include <stdint.h>
@@ -9,17 +11,6 @@
 
 #include <lz4.h>
 
-int SpngStreamRead(spng_ctx *ctx, void *user, void *dest, size_t length)
-{
-	auto *file = (std::ifstream*)user;
-	file->read((char *)dest, length);
-	if(file->eof())
-		return SPNG_IO_EOF;
-	else if(file->fail())
-		return SPNG_IO_ERROR;
-	return 0;
-}
-
 void* ImageData::defaultAllocator(size_t size)
 {
 	return new char[size];
@@ -64,7 +55,13 @@ ImageData::~ImageData()
 
 bool ImageData::LoadAny(std::filesystem::path image)
 {
-	if(!LoadLzs3(image) && !LoadPng(image) && !LoadRaw(image))
+	auto file = vfs::Open(image);
+	if(!file)
+	{
+		std::cerr << image<<": error opening input file\n";
+		return false;
+	}
+	if(!LoadAny(file.Data(), file.Size()))
 	{
 		std::cerr << image<<": invalid image file\n";
 		return false;
@@ -72,6 +69,11 @@ bool ImageData::LoadAny(std::filesystem::path image)
 	return true;
 }
 
+bool ImageData::LoadAny(const uint8_t *data, size_t size)
+{
+	return LoadLzs3(data, size) || LoadPng(data, size) || LoadRaw(data, size);
+}
+
 std::size_t ImageData::GetMemSize() const
 {
 	return width*height*bytesPerPixel;
@@ -88,10 +90,17 @@ struct raw_header{
 
 int ImageData::PeekBytesPerPixel(std::filesystem::path path)
 {
-	std::ifstream image(path, std::ios_base::binary);
-	if(image.fail())
+	auto file = vfs::Open(path);
+	if(!file)
 		return false;
-	
+	int bpp = PeekBytesPerPixel(file.Data(), file.Size());
+	if(bpp < 0)
+		std::cerr << path <<"is not a valid image file.\n";
+	return bpp;
+}
+
+int ImageData::PeekBytesPerPixel(const uint8_t *data, size_t size)
+{
 	lzs3:{
 		struct{
 			uint32_t type;
@@ -99,7 +108,9 @@ int ImageData::PeekBytesPerPixel(std::filesystem::path path)
 			uint32_t cSize;
 			uint16_t w,h;
 		} meta{};
-		image.read((char*)&meta, sizeof(meta));
+		if(size < sizeof(meta))
+			goto png;
+		memcpy(&meta, data, sizeof(meta));
 		if((meta.type&~0x1000) > 4 || meta.w > 16384 || meta.h > 16384 || meta.size*2 < meta.cSize) //Checking valid header.
 			goto png;
 		if(meta.type & 0x1000)
@@ -108,7 +119,6 @@ int ImageData::PeekBytesPerPixel(std::filesystem::path path)
 			return 4;
 	}
 	png:{
-		image.seekg (0, image.beg);
 		std::unique_ptr<spng_ctx, decltype(&spng_ctx_free)> ctxObj(spng_ctx_new(0), &spng_ctx_free);
 		auto ctx = ctxObj.get();
 		if(ctx == NULL)
@@ -118,7 +128,7 @@ int ImageData::PeekBytesPerPixel(std::filesystem::path path)
 		spng_set_crc_action(ctx, SPNG_CRC_USE, SPNG_CRC_USE);
 		constexpr size_t limit = 4096 * 4096 * 16;
 		spng_set_chunk_limits(ctx, limit, limit);
-		spng_set_png_stream(ctx, SpngStreamRead, &image);
+		spng_set_png_buffer(ctx, data, size);
 
 		struct spng_ihdr ihdr;
 		int result = spng_get_ihdr(ctx, &ihdr);
@@ -141,37 +151,40 @@ int ImageData::PeekBytesPerPixel(std::filesystem::path path)
 		}
 	}
 	raw:{
-		image.seekg (0, image.beg);
 		raw_header meta;
-		image.read((char*)&meta, sizeof(meta));
+		if(size < sizeof(meta))
+			return -1;
+		memcpy(&meta, data, sizeof(meta));
 		if(meta.bpp > 4 || meta.w*meta.h*meta.bpp > 4096 * 4096 * 16)
 			goto err;
 		return meta.bpp;
 	}
 	err:
-		std::cerr << path <<"is not a valid image file.\n";
 		return -1;
 }
 
 bool ImageData::LoadPng(std::filesystem::path filename)
 {
-	FreeData();
-	
-	std::ifstream png(filename, std::ios_base::binary);
-	int r; //result
-
-	if(png.fail())
+	auto file = vfs::Open(filename);
+	if(!file)
 	{
 		std::cerr <<filename<<": error opening input file \n";
 		return false;
 	}
-	
+	return LoadPng(file.Data(), file.Size());
+}
+
+bool ImageData::LoadPng(const uint8_t *pngData, size_t pngSize)
+{
+	FreeData();
+	int r; //result
+
 	std::unique_ptr<spng_ctx, decltype(&spng_ctx_free)> ctxObj(spng_ctx_new(0), &spng_ctx_free);
 	auto ctx = ctxObj.get();
 
 	if(ctx == NULL)
 	{
-		std::cerr <<filename<<": spng_ctx_new() failed\n";
+		std::cerr <<"spng_ctx_new() failed\n";
 		return false;
 	}
 
@@ -184,7 +197,7 @@ bool ImageData::LoadPng(std::filesystem::path filename)
 	spng_set_chunk_limits(ctx, limit, limit);
 
 	/* Set source PNG */
-	spng_set_png_stream(ctx, SpngStreamRead, &png);
+	spng_set_png_buffer(ctx, pngData, pngSize);
 
 	struct spng_ihdr ihdr;
 	r = spng_get_ihdr(ctx, &ihdr);
@@ -292,42 +305,49 @@ bool ImageData::LoadPng(std::filesystem::path filename)
 
 
 bool ImageData::LoadRaw(std::filesystem::path filename)
+{
+	auto file = vfs::Open(filename);
+	if(!file)
+		return false;
+	return LoadRaw(file.Data(), file.Size());
+}
+
+bool ImageData::LoadRaw(const uint8_t *rawData, size_t rawSize)
 {
 	FreeData();
 
-	std::ifstream in(filename, std::ios_base::binary);
-	if(!in.is_open())
-		return false;
-	
 	raw_header meta;
-	in.read((char*)&meta, sizeof(meta));
-	int size = meta.w*meta.h*meta.bpp;
-	if(size > 4096 * 4096 * 16)
+	if(rawSize < sizeof(meta))
+		return false;
+	memcpy(&meta, rawData, sizeof(meta));
+	uint64_t size = (uint64_t)meta.w*meta.h*meta.bpp;
+	if(size > 4096 * 4096 * 16 || sizeof(meta) + size > rawSize)
 		return false;
 
 	width = meta.w;
 	height = meta.h;
 	bytesPerPixel = meta.bpp;
 	*alloc.ptr = alloc.allocate(size); //(uint8_t*)malloc(size);
-	in.read((char*)*alloc.ptr, size);
-	if(in.fail())
-	{
-		alloc.deallocate(alloc.ptr);
+	if(*alloc.ptr == nullptr)
 		return false;
-	}
+	memcpy(*alloc.ptr, rawData + sizeof(meta), size);
 	return true;
 }
 
 bool ImageData::LoadLzs3(std::filesystem::path imageFile)
 {
-	FreeData();
-
-	std::ifstream file(imageFile, std::ios::binary);
-	if(!file.is_open())
+	auto file = vfs::Open(imageFile);
+	if(!file)
 	{
 		std::cerr<< "Couldn't open image " << imageFile.string()<<"\n";
 		return false;
 	}
+	return LoadLzs3(file.Data(), file.Size());
+}
+
+bool ImageData::LoadLzs3(const uint8_t *lzs3Data, size_t lzs3Size)
+{
+	FreeData();
 
 	struct{
 		uint32_t type;
@@ -335,19 +355,24 @@ bool ImageData::LoadLzs3(std::filesystem::path imageFile)
 		uint32_t cSize;
 		uint16_t w,h;
 	} meta{};
-	file.read((char*)&meta, sizeof(meta));
+	if(lzs3Size < sizeof(meta))
+		return false;
+	memcpy(&meta, lzs3Data, sizeof(meta));
 	if((meta.type&~0x1000) > 4 || meta.w > 16384 || meta.h > 16384 || meta.size*2 < meta.cSize) //Checking valid header.
 		return false;
+	if(sizeof(meta) + (uint64_t)meta.cSize > lzs3Size)
+		return false;
 
 	*alloc.ptr = alloc.allocate(meta.size);
-	auto cData = std::make_unique<char[]>(meta.cSize);
-	file.read(cData.get(), meta.cSize);
+	if(*alloc.ptr == nullptr)
+		return false;
 
-	int decompSize = LZ4_decompress_safe(cData.get(), (char*)*alloc.ptr, meta.cSize, meta.size);
-	if(decompSize < 0 || decompSize != meta.size)
+	//Decompressed straight from the file data, no intermediate copy.
+	int decompSize = LZ4_decompress_safe((const char*)lzs3Data + sizeof(meta), (char*)*alloc.ptr, meta.cSize, meta.size);
+	if(decompSize < 0 || (uint32_t)decompSize != meta.size)
 	{
 		alloc.deallocate(alloc.ptr);
-		std::cerr << "Texture::LoadLzs3: Error while decompressing LZ4 - " << imageFile.filename()<< "\n";
+		std::cerr << "Texture::LoadLzs3: Error while decompressing LZ4\n";
 		return false;
 	}
 
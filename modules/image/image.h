@@ -28,12 +28,17 @@ public:
 	ImageData(std::filesystem::path image, Allocator alloc);
 	~ImageData();
 	
+	//Paths are opened through vfs, so they can be packed in the data archive.
 	static int PeekBytesPerPixel(std::filesystem::path image);
-	//bool PeekMem(void *memory);
+	static int PeekBytesPerPixel(const uint8_t *data, size_t size);
 	bool LoadAny(std::filesystem::path image);
 	bool LoadRaw(std::filesystem::path image);
 	bool LoadPng(std::filesystem::path image);
 	bool LoadLzs3(std::filesystem::path image);
+	bool LoadAny(const uint8_t *data, size_t size);
+	bool LoadRaw(const uint8_t *data, size_t size);
+	bool LoadPng(const uint8_t *data, size_t size);
+	bool LoadLzs3(const uint8_t *data, size_t size);
 	bool WriteRaw(std::filesystem::path path) const;
 	std::size_t GetMemSize() const;
 	void FreeData();
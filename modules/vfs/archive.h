@@ -0,0 +1,42 @@
+#ifndef ARCHIVE_H_GUARD
+#define ARCHIVE_H_GUARD
+
+#include <cstdint>
+
+//Layout of packed data archives as written by tools/packData.
+//A header, the table of contents sorted by name, the names and then the file data.
+//The index is used straight from the mapping, so everything is little endian and naturally aligned.
+namespace archive
+{
+	constexpr uint32_t magic = 0x41464741; //AGFA
+	constexpr uint32_t version = 1;
+
+	struct Header
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint32_t entryCount;
+		uint32_t namesSize; //Names come right after the entries. They're not null terminated.
+	};
+
+	enum EntryFlags : uint32_t
+	{
+		lz4 = 1, //Stored compressed, size is the decompressed size.
+	};
+
+	struct Entry
+	{
+		uint64_t offset; //From the start of the archive.
+		uint64_t size;
+		uint64_t storedSize;
+		uint32_t nameOffset; //Relative to the names block. Names use '/' as separator, like "data/char/vaki/def.lua".
+		uint32_t nameSize;
+		uint32_t flags;
+		uint32_t alignment; //offset is a multiple of this.
+	};
+
+	static_assert(sizeof(Header) == 16);
+	static_assert(sizeof(Entry) == 40);
+}
+
+#endif /* ARCHIVE_H_GUARD */
@@ -0,0 +1,122 @@
+#include "mapped_file.h"
+#include <utility>
+
+#ifdef _WIN32
+	#define WIN32_LEAN_AND_MEAN
+	#define NOMINMAX
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(MappedFile &&other)
+{
+	*this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile &&other)
+{
+	if(this == &other)
+		return *this;
+	Close();
+	data = std::exchange(other.data, nullptr);
+	size = std::exchange(other.size, 0);
+#ifdef _WIN32
+	file = std::exchange(other.file, nullptr);
+	mapping = std::exchange(other.mapping, nullptr);
+#endif
+	return *this;
+}
+
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+#ifdef _WIN32
+bool MappedFile::Open(const std::filesystem::path &path)
+{
+	Close();
+	HANDLE handle = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if(handle == INVALID_HANDLE_VALUE)
+		return false;
+	file = handle;
+
+	LARGE_INTEGER fileSize;
+	if(!GetFileSizeEx(handle, &fileSize))
+	{
+		Close();
+		return false;
+	}
+	size = fileSize.QuadPart;
+	if(size == 0) //Can't map empty files.
+		return true;
+
+	mapping = CreateFileMappingW(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if(mapping)
+		data = (const uint8_t*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if(!data)
+	{
+		Close();
+		return false;
+	}
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if(data)
+		UnmapViewOfFile(data);
+	if(mapping)
+		CloseHandle(mapping);
+	if(file)
+		CloseHandle(file);
+	data = nullptr;
+	mapping = nullptr;
+	file = nullptr;
+	size = 0;
+}
+#else
+bool MappedFile::Open(const std::filesystem::path &path)
+{
+	Close();
+	int fd = open(path.c_str(), O_RDONLY);
+	if(fd < 0)
+		return false;
+
+	struct stat info;
+	if(fstat(fd, &info) != 0)
+	{
+		close(fd);
+		return false;
+	}
+	size = info.st_size;
+	if(size == 0) //Can't map empty files.
+	{
+		close(fd);
+		return true;
+	}
+
+	void *mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd); //The mapping keeps its own reference.
+	if(mapped == MAP_FAILED)
+	{
+		size = 0;
+		return false;
+	}
+	posix_madvise(mapped, size, POSIX_MADV_SEQUENTIAL);
+	data = (const uint8_t*)mapped;
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if(data)
+		munmap((void*)data, size);
+	data = nullptr;
+	size = 0;
+}
+#endif
@@ -0,0 +1,35 @@
+#ifndef MAPPED_FILE_H_GUARD
+#define MAPPED_FILE_H_GUARD
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+
+//Read only mapping of a whole file. Pages are read by the OS as they're touched,
+//so nothing has to be copied into a buffer of our own first.
+class MappedFile
+{
+public:
+	MappedFile() = default;
+	MappedFile(MappedFile &&other);
+	MappedFile& operator=(MappedFile &&other);
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+	~MappedFile();
+
+	bool Open(const std::filesystem::path &path); //Returns false if the file can't be opened.
+	void Close();
+
+	const uint8_t *Data() const { return data; }
+	size_t Size() const { return size; }
+
+private:
+	const uint8_t *data = nullptr;
+	size_t size = 0;
+#ifdef _WIN32
+	void *file = nullptr;
+	void *mapping = nullptr;
+#endif
+};
+
+#endif /* MAPPED_FILE_H_GUARD */
@@ -0,0 +1,136 @@
+#include "vfs.h"
+#include "archive.h"
+#include <lz4.h>
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+namespace
+{
+	struct Mounted
+	{
+		MappedFile file;
+		const archive::Entry *entries = nullptr;
+		uint32_t count = 0;
+		const char *names = nullptr;
+
+		std::string_view Name(const archive::Entry &entry) const
+		{
+			return {names + entry.nameOffset, entry.nameSize};
+		}
+
+		const archive::Entry *Find(std::string_view name) const
+		{
+			auto end = entries + count;
+			auto it = std::lower_bound(entries, end, name, [this](const archive::Entry &entry, std::string_view name){
+				return Name(entry) < name;
+			});
+			if(it != end && Name(*it) == name)
+				return it;
+			return nullptr;
+		}
+	} mounted;
+
+	std::string ArchiveName(const std::filesystem::path &path)
+	{
+		return path.lexically_normal().generic_string();
+	}
+}
+
+namespace vfs
+{
+
+bool Mount(const std::filesystem::path &path)
+{
+	Unmount();
+	MappedFile file;
+	if(!file.Open(path))
+		return false;
+
+	auto invalid = [&path](){
+		std::cerr << path << ": invalid archive.\n";
+		return false;
+	};
+
+	archive::Header header;
+	if(file.Size() < sizeof(header))
+		return invalid();
+	memcpy(&header, file.Data(), sizeof(header));
+	if(header.magic != archive::magic || header.version != archive::version)
+		return invalid();
+
+	size_t namesStart = sizeof(header) + sizeof(archive::Entry)*(size_t)header.entryCount;
+	if(namesStart + header.namesSize > file.Size())
+		return invalid();
+
+	//LZ4 can't expand data more than this.
+	constexpr uint64_t maxLz4Ratio = 255;
+
+	//The index is only checked once here, lookups trust it afterwards.
+	mounted.entries = (const archive::Entry*)(file.Data() + sizeof(header));
+	mounted.count = header.entryCount;
+	mounted.names = (const char*)file.Data() + namesStart;
+	for(uint32_t i = 0; i < mounted.count; ++i)
+	{
+		auto &entry = mounted.entries[i];
+		bool sizeFits = entry.flags & archive::lz4 ?
+			entry.storedSize <= LZ4_MAX_INPUT_SIZE && entry.size <= LZ4_MAX_INPUT_SIZE && entry.size <= entry.storedSize*maxLz4Ratio :
+			entry.size == entry.storedSize; //Raw entries are read straight from the mapping.
+		if((uint64_t)entry.nameOffset + entry.nameSize > header.namesSize
+			|| entry.offset > file.Size() || entry.storedSize > file.Size() - entry.offset || !sizeFits
+			|| entry.alignment == 0 || entry.offset % entry.alignment != 0
+			|| (i > 0 && !(mounted.Name(mounted.entries[i-1]) < mounted.Name(entry))))
+		{
+			mounted = {};
+			return invalid();
+		}
+	}
+	mounted.file = std::move(file);
+	return true;
+}
+
+void Unmount()
+{
+	mounted = {};
+}
+
+File Open(const std::filesystem::path &path)
+{
+	File file;
+	if(auto entry = mounted.Find(ArchiveName(path)))
+	{
+		const uint8_t *stored = mounted.file.Data() + entry->offset;
+		if(entry->flags & archive::lz4)
+		{
+			file.buffer = std::make_unique<uint8_t[]>(entry->size);
+			int size = LZ4_decompress_safe((const char*)stored, (char*)file.buffer.get(), entry->storedSize, entry->size);
+			if(size < 0 || (uint64_t)size != entry->size)
+			{
+				std::cerr << path << ": error while decompressing archive entry.\n";
+				return {};
+			}
+			file.data = file.buffer.get();
+		}
+		else
+			file.data = stored;
+		file.size = entry->size;
+		file.found = true;
+		return file;
+	}
+
+	if(file.mapping.Open(path))
+	{
+		file.data = file.mapping.Data();
+		file.size = file.mapping.Size();
+		file.found = true;
+	}
+	return file;
+}
+
+bool Exists(const std::filesystem::path &path)
+{
+	return mounted.Find(ArchiveName(path)) || std::filesystem::is_regular_file(path);
+}
+
+}
@@ -0,0 +1,43 @@
+#ifndef VFS_H_GUARD
+#define VFS_H_GUARD
+
+#include "mapped_file.h"
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string_view>
+
+//Read only access to game data. Files are looked up in the mounted archive first and
+//read from disk when they aren't packed, so loose files keep working without an archive.
+namespace vfs
+{
+	//Contents of a single file. Points into the archive mapping if the entry is stored as is,
+	//otherwise it maps the loose file or owns the decompressed data.
+	class File
+	{
+	public:
+		const uint8_t *Data() const { return data; }
+		size_t Size() const { return size; }
+		std::string_view View() const { return {(const char*)data, size}; }
+		explicit operator bool() const { return found; }
+
+	private:
+		friend File Open(const std::filesystem::path &path);
+		const uint8_t *data = nullptr;
+		size_t size = 0;
+		bool found = false;
+		MappedFile mapping;
+		std::unique_ptr<uint8_t[]> buffer;
+	};
+
+	//Not thread safe. Call before anything is loaded. Returns false if the archive is missing or invalid.
+	bool Mount(const std::filesystem::path &archive);
+	void Unmount();
+
+	//Safe to call from several threads. Evaluates to false if the file doesn't exist.
+	File Open(const std::filesystem::path &path);
+	bool Exists(const std::filesystem::path &path);
+}
+
+#endif /* VFS_H_GUARD */
@@ -0,0 +1,113 @@
+#include "test.h"
+#include <particle.h>
+#include <worker_pool.h>
+#include <xorshift.h>
+#include <vector>
+
+//Gives every particle values that can be told apart after packing.
+static void AddParticles(ParticleGroup &group, uint32_t type, size_t count)
+{
+	auto &data = group.particleTypes[type];
+	size_t first = data.Grow(count);
+	for(size_t i = first; i < first + count; ++i)
+	{
+		float f = type*100000.f + i;
+		data.pos[0][i] = f;
+		data.pos[1][i] = -f;
+		data.scale[0][i] = f + 0.25f;
+		data.scale[1][i] = f + 0.5f;
+		data.sin[i] = 0.125f;
+		data.cos[i] = -0.75f;
+		data.texId[i] = type;
+		for(int c = 0; c < 4; ++c)
+			data.color[c][i] = (i + c*7 + type) % 256;
+	}
+}
+
+static bool Matches(const ParticleGroup::ParticleTypeData &data, size_t i, const ParticleGroup::Particle &p)
+{
+	bool same = p.pos[0] == data.pos[0][i] && p.pos[1] == data.pos[1][i] &&
+		p.scale[0] == data.scale[0][i] && p.scale[1] == data.scale[1][i] &&
+		p.sin == data.sin[i] && p.cos == data.cos[i] && p.texId == data.texId[i];
+	for(int c = 0; c < 4; ++c)
+		same = same && p.color[c] == (uint8_t)data.color[c][i];
+	return same;
+}
+
+//Every range must be where FillBuffer says it is, back to back from the start, and hold its type's particles in order.
+static void CheckPacked(const ParticleGroup &group, const std::vector<ParticleGroup::Particle> &buffer,
+	const std::vector<ParticleGroup::DrawInfo> &draws, size_t expectedTotal)
+{
+	size_t next = 0;
+	for(auto &draw : draws)
+	{
+		CHECK(draw.first == next);
+		CHECK(draw.particleAmount > 0);
+		auto &data = group.particleTypes.at(draw.particleType);
+		CHECK(draw.particleAmount <= data.size());
+		for(size_t i = 0; i < draw.particleAmount; ++i)
+		{
+			if(!Matches(data, i, buffer[draw.first + i]))
+			{
+				CHECK(!"packed particle differs");
+				break;
+			}
+		}
+		next += draw.particleAmount;
+	}
+	CHECK(next == expectedTotal);
+}
+
+static void FillsEveryType()
+{
+	XorShift32 rng;
+	ParticleGroup group(rng);
+	AddParticles(group, 1, 10);
+	AddParticles(group, 2, 1);
+	AddParticles(group, 7, 300);
+	group.particleTypes[9]; //Empty types get no range.
+
+	std::vector<ParticleGroup::Particle> buffer(1000);
+	auto draws = group.FillBuffer(buffer.data(), buffer.size());
+	CHECK(draws.size() == 3);
+	CheckPacked(group, buffer, draws, 311);
+}
+
+static void DropsPastCapacity()
+{
+	XorShift32 rng;
+	ParticleGroup group(rng);
+	AddParticles(group, 1, 50);
+	AddParticles(group, 2, 50);
+
+	//The buffer is exactly as big as needed so writing past the capacity would show up with sanitizers.
+	std::vector<ParticleGroup::Particle> buffer(70);
+	auto draws = group.FillBuffer(buffer.data(), buffer.size());
+	CheckPacked(group, buffer, draws, 70);
+
+	buffer.clear();
+	CHECK(group.FillBuffer(buffer.data(), 0).empty());
+}
+
+static void PacksInParallel()
+{
+	XorShift32 rng;
+	WorkerPool workers(3);
+	ParticleGroup group(rng, &workers);
+	size_t big = ParticleGroup::parallelThreshold + ParticleGroup::chunkSize/2 + 3; //Ends in a partial chunk.
+	AddParticles(group, 3, big);
+	AddParticles(group, 4, 5);
+
+	std::vector<ParticleGroup::Particle> buffer(big + 5);
+	auto draws = group.FillBuffer(buffer.data(), buffer.size());
+	CHECK(draws.size() == 2);
+	CheckPacked(group, buffer, draws, big + 5);
+}
+
+int main()
+{
+	FillsEveryType();
+	DropsPastCapacity();
+	PacksInParallel();
+	return TestResult();
+}
@@ -0,0 +1,102 @@
+#include "test.h"
+#include <sound_queue.h>
+
+//The null driver never mixes, so voices stay alive until they're stopped.
+static SoLoud::Soloud soloud;
+
+//Wavs stop their voices when destroyed, so these have to go before SoLoud does.
+struct Sounds
+{
+	SoLoud::Wav hit, block;
+};
+
+static void NotPlayedTwice(Sounds &s)
+{
+	SoundQueue queue(soloud);
+	queue.Request(10, &s.hit);
+	queue.Request(11, &s.block);
+	queue.Dispatch(11);
+	CHECK(soloud.getVoiceCount() == 2);
+
+	//Same sounds on the same frames after resimulating.
+	queue.Rollback(10);
+	queue.Request(10, &s.hit);
+	queue.Request(11, &s.block);
+	queue.Dispatch(11);
+	CHECK(soloud.getVoiceCount() == 2);
+
+	//A second rollback over the same frames still matches them.
+	queue.Rollback(9);
+	queue.Request(10, &s.hit);
+	queue.Request(11, &s.block);
+	queue.Dispatch(12);
+	CHECK(soloud.getVoiceCount() == 2);
+	soloud.stopAll();
+}
+
+static void MispredictedStopped(Sounds &s)
+{
+	SoundQueue queue(soloud);
+	queue.Request(5, &s.hit);
+	queue.Request(6, &s.block);
+	queue.Dispatch(6);
+	CHECK(soloud.getVoiceCount() == 2);
+
+	//Frame 6 makes no sound this time. Frame 5 stays as it was.
+	queue.Rollback(6);
+	queue.Dispatch(6);
+	CHECK(soloud.getVoiceCount() == 1);
+
+	//A different sound on the resimulated frame replaces the old one.
+	queue.Rollback(5);
+	queue.Request(5, &s.block);
+	queue.Dispatch(6);
+	CHECK(soloud.getVoiceCount() == 1);
+
+	//The request made before the rollback is dropped too.
+	queue.Request(7, &s.hit);
+	queue.Rollback(7);
+	queue.Dispatch(7);
+	CHECK(soloud.getVoiceCount() == 1);
+	soloud.stopAll();
+}
+
+static void OldEventsPruned(Sounds &s)
+{
+	SoundQueue queue(soloud);
+	queue.Request(0, &s.hit);
+	queue.Dispatch(0);
+	queue.Dispatch(SoundQueue::historyFrames); //Still recent enough.
+	queue.Rollback(0);
+	queue.Dispatch(SoundQueue::historyFrames);
+	CHECK(soloud.getVoiceCount() == 0);
+
+	queue.Request(0, &s.hit);
+	queue.Dispatch(0);
+	queue.Dispatch(SoundQueue::historyFrames+1); //Too old now, so it's forgotten.
+	queue.Rollback(0);
+	queue.Dispatch(SoundQueue::historyFrames+1);
+	CHECK(soloud.getVoiceCount() == 1);
+	soloud.stopAll();
+}
+
+int main()
+{
+	if(soloud.init(SoLoud::Soloud::CLIP_ROUNDOFF, SoLoud::Soloud::NULLDRIVER) != SoLoud::SO_NO_ERROR)
+	{
+		std::cerr << "Can't start SoLoud's null driver.\n";
+		return 1;
+	}
+	{
+		Sounds sounds;
+		float silence[64] = {};
+		sounds.hit.loadRawWave(silence, 64, 44100, 1, true, false);
+		sounds.block.loadRawWave(silence, 64, 44100, 1, true, false);
+
+		NotPlayedTwice(sounds);
+		MispredictedStopped(sounds);
+		OldEventsPruned(sounds);
+	}
+	soloud.deinit();
+	return TestResult();
+}
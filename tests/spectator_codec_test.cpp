@@ -0,0 +1,82 @@
+#include "test.h"
+#include <spectator_codec.h>
+#include <vector>
+
+//Encodes, then decodes what was written and checks nothing was left over.
+static bool RoundTrip(const std::vector<uint32_t> &inputs, uint32_t previous)
+{
+	std::vector<uint8_t> data;
+	spectator::Encode(inputs.data(), inputs.size(), previous, data);
+	const uint8_t *read = data.data();
+	std::vector<uint32_t> decoded;
+	bool ok = spectator::Decode(read, data.data() + data.size(), inputs.size(), previous, decoded);
+	return ok && decoded == inputs && read == data.data() + data.size();
+}
+
+static void AllEqual()
+{
+	std::vector<uint32_t> held(600, 0x21);
+	CHECK(RoundTrip(held, 0x21));
+	std::vector<uint8_t> data;
+	spectator::Encode(held.data(), held.size(), 0x21, data);
+	CHECK(data.size() == 3); //One run of 600 and an empty change.
+
+	CHECK(RoundTrip(std::vector<uint32_t>(1000, 0), 0));
+	CHECK(RoundTrip({}, 5));
+}
+
+static void TrailingRuns()
+{
+	CHECK(RoundTrip({1, 2, 3, 3, 3, 3}, 0));
+	CHECK(RoundTrip({0, 0, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7}, 0));
+	CHECK(RoundTrip({9}, 9));
+}
+
+//Packets after the first start from the last input the spectator already has.
+static void FirstFrameChangesFromPrevious()
+{
+	CHECK(RoundTrip({0, 0, 4}, 0xFFFFFFFF));
+	CHECK(RoundTrip({0x80000000, 0x80000001, 0x1}, 0x12345678));
+
+	//Both players go back to back in a packet, so each one has to stop where its own data ends.
+	std::vector<uint32_t> p1{1, 1, 2}, p2{8, 8, 8};
+	std::vector<uint8_t> data;
+	spectator::Encode(p1.data(), p1.size(), 3, data);
+	spectator::Encode(p2.data(), p2.size(), 8, data);
+	const uint8_t *read = data.data();
+	const uint8_t *end = data.data() + data.size();
+	std::vector<uint32_t> d1, d2;
+	CHECK(spectator::Decode(read, end, p1.size(), 3, d1));
+	CHECK(spectator::Decode(read, end, p2.size(), 8, d2));
+	CHECK(d1 == p1 && d2 == p2 && read == end);
+}
+
+static void Truncated()
+{
+	std::vector<uint32_t> inputs{1, 2, 2, 2, 0x4000, 0x4000, 3};
+	std::vector<uint8_t> data;
+	spectator::Encode(inputs.data(), inputs.size(), 0, data);
+	for(size_t size = 0; size < data.size(); ++size)
+	{
+		const uint8_t *read = data.data();
+		std::vector<uint32_t> decoded;
+		CHECK(!spectator::Decode(read, data.data() + size, inputs.size(), 0, decoded));
+	}
+
+	//A run longer than the frames asked for is broken too.
+	std::vector<uint32_t> held(10, 0);
+	data.clear();
+	spectator::Encode(held.data(), held.size(), 0, data);
+	const uint8_t *read = data.data();
+	std::vector<uint32_t> decoded;
+	CHECK(!spectator::Decode(read, data.data() + data.size(), 5, 0, decoded));
+}
+
+int main()
+{
+	AllEqual();
+	TrailingRuns();
+	FirstFrameChangesFromPrevious();
+	Truncated();
+	return TestResult();
+}
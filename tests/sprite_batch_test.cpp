@@ -0,0 +1,96 @@
+#include "test.h"
+#include <sprite_batch.h>
+#include <vector>
+
+static SpriteInstance Sprite(int shaderType, int textureIndex, int paletteSlot = 0)
+{
+	SpriteInstance sprite{};
+	sprite.shaderType = shaderType;
+	sprite.textureIndex = textureIndex;
+	sprite.paletteSlot = paletteSlot;
+	return sprite;
+}
+
+//Different meshes on the same texture share a draw, and each instance keeps its own vertex range.
+static void MergesMeshesOnSameTexture()
+{
+	SpriteBatch batch;
+	batch.Add({0, 6}, Sprite(0, 2, 0));
+	batch.Add({60, 12}, Sprite(0, 2, 1));
+	batch.Add({6, 6}, Sprite(0, 2, 2));
+
+	std::vector<SpriteInstance> out(8);
+	auto batches = batch.Build(out.data(), out.size());
+	CHECK(batches.size() == 1);
+	CHECK(batches[0].firstInstance == 0);
+	CHECK(batches[0].instanceCount == 3);
+	CHECK(batches[0].vertexCount == 12);
+	CHECK(out[0].firstVertex == 0 && out[0].vertexCount == 6);
+	CHECK(out[1].firstVertex == 60 && out[1].vertexCount == 12);
+	CHECK(out[2].firstVertex == 6 && out[2].vertexCount == 6);
+	for(int i = 0; i < 3; ++i)
+		CHECK(out[i].paletteSlot == i);
+	CHECK(batch.Empty());
+}
+
+//Sprites are blended in the order they're added, so a texture that comes back starts a new draw.
+static void SplitsOnShaderTypeAndTexture()
+{
+	SpriteBatch batch;
+	batch.Add({0, 6}, Sprite(0, 1));
+	batch.Add({0, 6}, Sprite(0, 1));
+	batch.Add({0, 6}, Sprite(0, 3));
+	batch.Add({0, 6}, Sprite(1, 3));
+	batch.Add({0, 6}, Sprite(0, 1));
+
+	std::vector<SpriteInstance> out(8);
+	auto batches = batch.Build(out.data(), out.size());
+	CHECK(batches.size() == 4);
+	uint32_t next = 0;
+	for(auto &b : batches)
+	{
+		CHECK(b.firstInstance == next);
+		next += b.instanceCount;
+	}
+	CHECK(next == 5);
+	CHECK(batches[0].instanceCount == 2);
+}
+
+//A big mesh after small ones would mostly draw discarded vertices, so it gets its own draw.
+static void SplitsWhenMostVerticesWouldBeDiscarded()
+{
+	SpriteBatch batch;
+	batch.Add({0, 6}, Sprite(0, 0));
+	batch.Add({0, 6}, Sprite(0, 0));
+	batch.Add({0, 6}, Sprite(0, 0));
+	batch.Add({6, 600}, Sprite(0, 0));
+
+	std::vector<SpriteInstance> out(8);
+	auto batches = batch.Build(out.data(), out.size());
+	CHECK(batches.size() == 2);
+	CHECK(batches[0].instanceCount == 3 && batches[0].vertexCount == 6);
+	CHECK(batches[1].firstInstance == 3 && batches[1].vertexCount == 600);
+}
+
+static void DropsPastCapacity()
+{
+	SpriteBatch batch;
+	for(int i = 0; i < 5; ++i)
+		batch.Add({0, 6}, Sprite(0, i % 2));
+
+	std::vector<SpriteInstance> out(3);
+	auto batches = batch.Build(out.data(), out.size());
+	CHECK(batches.size() == 3);
+	CHECK(batches.back().firstInstance + batches.back().instanceCount == 3);
+	CHECK(batch.Empty());
+	CHECK(batch.Build(out.data(), out.size()).empty());
+}
+
+int main()
+{
+	MergesMeshesOnSameTexture();
+	SplitsOnShaderTypeAndTexture();
+	SplitsWhenMostVerticesWouldBeDiscarded();
+	DropsPastCapacity();
+	return TestResult();
+}
@@ -0,0 +1,26 @@
+#ifndef TEST_H_GUARD
+#define TEST_H_GUARD
+
+#include <iostream>
+
+//Minimal checks for the tests. Failures are printed and the test keeps going.
+inline int testFailures = 0;
+
+#define CHECK(condition) \
+	do{ \
+		if(!(condition)) \
+		{ \
+			std::cerr << __FILE__ << ":" << __LINE__ << ": Check failed: " #condition "\n"; \
+			++testFailures; \
+		} \
+	}while(0)
+
+//Return from main.
+inline int TestResult()
+{
+	if(testFailures)
+		std::cerr << testFailures << " checks failed.\n";
+	return testFailures ? 1 : 0;
+}
+
+#endif /* TEST_H_GUARD */
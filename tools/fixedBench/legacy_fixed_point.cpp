@@ -0,0 +1,73 @@
+#include "legacy_fixed_point.h"
+
+LegacyFixedPoint::LegacyFixedPoint(int number) : value(static_cast<fixed_t>(number << fracBits)) {}
+LegacyFixedPoint::LegacyFixedPoint(double number) : value(static_cast<fixed_t>(number*fracUnit)) {}
+
+LegacyFixedPoint LegacyFixedPoint::operator+(LegacyFixedPoint a) const
+{
+	LegacyFixedPoint result;
+	result.value = value + a.value;
+	return result;
+}
+
+LegacyFixedPoint LegacyFixedPoint::operator-(LegacyFixedPoint a) const
+{
+	LegacyFixedPoint result;
+	result.value = value - a.value;
+	return result;
+}
+
+LegacyFixedPoint LegacyFixedPoint::operator*(LegacyFixedPoint a) const
+{
+	LegacyFixedPoint result;
+	std::int64_t mul = static_cast<std::int64_t>(value) * static_cast<std::int64_t>(a.value);
+	mul >>= fracBits;
+	result.value = static_cast<fixed_t>(mul);
+	return result;
+}
+
+LegacyFixedPoint LegacyFixedPoint::operator/(LegacyFixedPoint a) const
+{
+	LegacyFixedPoint result;
+	std::int64_t div = static_cast<std::int64_t>(value) << fracBits;
+	div /= a.value;
+	result.value = static_cast<fixed_t>(div);
+	return result;
+}
+
+void LegacyFixedPoint::operator+=(LegacyFixedPoint a)
+{
+	value += a.value;
+}
+
+void LegacyFixedPoint::operator-=(LegacyFixedPoint a)
+{
+	value -= a.value;
+}
+
+LegacyFixedPoint LegacyFixedPoint::operator-() const
+{
+	LegacyFixedPoint result;
+	result.value = -value;
+	return result;
+}
+
+bool LegacyFixedPoint::operator<(const LegacyFixedPoint &a) const
+{
+	return value < a.value;
+}
+
+bool LegacyFixedPoint::operator>(const LegacyFixedPoint &a) const
+{
+	return value > a.value;
+}
+
+bool LegacyFixedPoint::operator<=(const LegacyFixedPoint &a) const
+{
+	return value <= a.value;
+}
+
+bool LegacyFixedPoint::operator>=(const LegacyFixedPoint &a) const
+{
+	return value >= a.value;
+}
@@ -0,0 +1,36 @@
+#ifndef LEGACY_FIXED_POINT_H_GUARD
+#define LEGACY_FIXED_POINT_H_GUARD
+
+#include <cstdint>
+
+//The operators of the old FixedPoint, still defined out of line, as they were before the header only template.
+//Only what the benchmark uses.
+class LegacyFixedPoint
+{
+public:
+	typedef std::int32_t fixed_t;
+	fixed_t value = 0;
+
+	LegacyFixedPoint() = default;
+	LegacyFixedPoint(int number);
+	LegacyFixedPoint(double number);
+
+	LegacyFixedPoint operator+(LegacyFixedPoint a) const;
+	LegacyFixedPoint operator-(LegacyFixedPoint a) const;
+	LegacyFixedPoint operator*(LegacyFixedPoint a) const;
+	LegacyFixedPoint operator/(LegacyFixedPoint a) const;
+	void operator+=(LegacyFixedPoint a);
+	void operator-=(LegacyFixedPoint a);
+	LegacyFixedPoint operator-() const;
+
+	bool operator<(const LegacyFixedPoint &a) const;
+	bool operator>(const LegacyFixedPoint &a) const;
+	bool operator<=(const LegacyFixedPoint &a) const;
+	bool operator>=(const LegacyFixedPoint &a) const;
+
+private:
+	static constexpr int fracBits = 16;
+	static constexpr int fracUnit = 1 << fracBits;
+};
+
+#endif /* LEGACY_FIXED_POINT_H_GUARD */
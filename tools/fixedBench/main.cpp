@@ -0,0 +1,134 @@
+#include <args.hxx>
+#include <fixed_point.h>
+#include "legacy_fixed_point.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+template<typename T>
+struct Body
+{
+	T x, y;
+	T velX, velY;
+	T halfWidth, halfHeight;
+};
+
+//Roughly what actors do every frame: integrate, apply friction, land on the floor, bounce off walls and check box overlaps.
+template<typename T>
+static uint64_t Simulate(std::vector<Body<T>> &bodies, int steps)
+{
+	const T gravity(-0.35);
+	const T friction(0.96875);
+	const T bounce(0.5);
+	const T floor(0);
+	const T wall(480);
+	uint64_t overlaps = 0;
+	for(int step = 0; step < steps; ++step)
+	{
+		for(auto &b : bodies)
+		{
+			b.velY += gravity;
+			b.velX = b.velX*friction;
+			b.x += b.velX;
+			b.y += b.velY;
+			if(b.y < floor)
+			{
+				b.y = floor;
+				b.velY = -b.velY*bounce;
+			}
+			if(b.x > wall || b.x < -wall)
+				b.velX = -b.velX;
+		}
+		for(size_t i = 1; i < bodies.size(); ++i)
+		{
+			auto &a = bodies[i-1];
+			auto &b = bodies[i];
+			if(a.x - a.halfWidth <= b.x + b.halfWidth && a.x + a.halfWidth >= b.x - b.halfWidth &&
+				a.y - a.halfHeight <= b.y + b.halfHeight && a.y + a.halfHeight >= b.y - b.halfHeight)
+				overlaps++;
+		}
+	}
+	return overlaps;
+}
+
+template<typename T>
+static std::vector<Body<T>> MakeBodies(int count)
+{
+	std::vector<Body<T>> bodies;
+	bodies.reserve(count);
+	for(int i = 0; i < count; ++i)
+	{
+		bodies.push_back({T((i*37)%900 - 450), T((i*13)%200), T(((i*7)%21 - 10)/4.0), T((i*11)%15/2.0),
+			T(20 + i%16), T(40 + i%32)});
+	}
+	return bodies;
+}
+
+template<typename T>
+static double Run(int bodyCount, int steps, int runs, uint64_t &overlaps, std::vector<int32_t> &raw)
+{
+	double best = 0;
+	for(int run = 0; run < runs; ++run)
+	{
+		auto bodies = MakeBodies<T>(bodyCount);
+		auto start = Clock::now();
+		overlaps = Simulate(bodies, steps);
+		double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+		best = run == 0 ? seconds : std::min(best, seconds);
+
+		raw.clear();
+		for(auto &b : bodies)
+			raw.insert(raw.end(), {b.x.value, b.y.value, b.velX.value, b.velY.value});
+	}
+	return best;
+}
+
+int main(int argc, char **argv)
+{
+	args::ArgumentParser parser("FixedPoint benchmark.",
+	"Runs the same actor-like workload with FixedPoint and with the old out of line implementation, "
+	"checks that both give the same results and prints the time per body update of the fastest run.");
+	args::HelpFlag help(parser, "help", "Display this help menu.", {'h', "help"});
+	args::ValueFlag<int> bodyCount(parser, "count", "Bodies to simulate. Defaults to 256.", {'b', "bodies"}, 256);
+	args::ValueFlag<int> steps(parser, "count", "Steps per run. Defaults to 20000.", {'s', "steps"}, 20000);
+	args::ValueFlag<int> runs(parser, "count", "Runs of each implementation. Defaults to 5.", {'r', "runs"}, 5);
+	try
+	{
+		parser.ParseCLI(argc, argv);
+	}
+	catch (const args::Help&)
+	{
+		std::cout << parser;
+		return 0;
+	}
+	catch (const args::ParseError& e)
+	{
+		std::cerr << e.what() << std::endl;
+		std::cerr << parser;
+		return 1;
+	}
+
+	int count = std::max(args::get(bodyCount), 2);
+	int stepCount = std::max(args::get(steps), 1);
+	int runCount = std::max(args::get(runs), 1);
+
+	uint64_t legacyOverlaps, newOverlaps;
+	std::vector<int32_t> legacyRaw, newRaw;
+	double legacy = Run<LegacyFixedPoint>(count, stepCount, runCount, legacyOverlaps, legacyRaw);
+	double current = Run<FixedPoint>(count, stepCount, runCount, newOverlaps, newRaw);
+
+	double updates = (double)count*stepCount;
+	std::cout << "Out of line: " << legacy/updates*1e9 << " ns per body update\n";
+	std::cout << "Header only: " << current/updates*1e9 << " ns per body update (" << legacy/current << "x)\n";
+	if(legacyOverlaps != newOverlaps || legacyRaw != newRaw)
+	{
+		std::cerr << "The results differ.\n";
+		return 1;
+	}
+	std::cout << "Results are identical.\n";
+	return 0;
+}
@@ -60,6 +60,7 @@ void Render::Draw()
 	gfx->Begin();
 	gfx->SetMatrix(projection*sView);
 	gfx->Draw(spriteId);
+	gfx->Flush();
 
 	//Boxes
 	hr->Draw(hPView);
@@ -48,7 +48,7 @@ startClock(std::chrono::high_resolution_clock::now())
 	}
 
 	renderer = new Renderer();
-	renderer->Init(window, true);
+	renderer->Init(window, true, "frametool_pipeline.cache");
 
 	ImGui_ImplSDL2_InitForVulkan(window);
 	auto info = renderer->GetImguiInfo();
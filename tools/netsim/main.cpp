@@ -0,0 +1,413 @@
+#include <args.hxx>
+#include <enet/enet.h>
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <queue>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+using Ms = std::chrono::duration<double, std::milli>;
+
+constexpr size_t maxPacketSize = 4096;
+
+static volatile std::sig_atomic_t quit = 0;
+
+//What a link does to the packets going through it. The schedule changes it over time.
+struct Conditions
+{
+	double latency = 0; //Milliseconds, one way.
+	double jitter = 0; //Milliseconds, uniformly added on top of the latency. Doesn't reorder by itself.
+	double loss = 0; //Percent.
+	double reorder = 0; //Percent of packets held back by reorderDelay so the ones after them get there first.
+	double reorderDelay = 20; //Milliseconds.
+	double bandwidth = 0; //Kbit/s. 0 is unlimited.
+	double queue = 200; //Milliseconds of packets the bandwidth cap can have queued before it drops them.
+
+	bool Set(const std::string &key, double value)
+	{
+		value = std::max(value, 0.0);
+		if(key == "latency") latency = value;
+		else if(key == "jitter") jitter = value;
+		else if(key == "loss") loss = std::min(value, 100.0);
+		else if(key == "reorder") reorder = std::min(value, 100.0);
+		else if(key == "reorderDelay") reorderDelay = value;
+		else if(key == "bandwidth") bandwidth = value;
+		else if(key == "queue") queue = value;
+		else return false;
+		return true;
+	}
+};
+
+struct Stats
+{
+	uint64_t packets = 0; //Delivered.
+	uint64_t bytes = 0;
+	uint64_t dropped = 0; //By the loss setting.
+	uint64_t queueDrops = 0; //By the bandwidth cap.
+	uint64_t reordered = 0;
+	double delaySum = 0; //Milliseconds between arrival and delivery.
+	double delayMax = 0;
+
+	void Add(size_t size, double delay)
+	{
+		packets++;
+		bytes += size;
+		delaySum += delay;
+		delayMax = std::max(delayMax, delay);
+	}
+};
+
+struct Packet
+{
+	Clock::time_point arrival;
+	Clock::time_point due;
+	uint64_t order; //Breaks ties so packets due at the same time keep their order.
+	std::vector<uint8_t> data;
+
+	bool operator>(const Packet &other) const
+	{
+		return due > other.due || (due == other.due && order > other.order);
+	}
+};
+
+//One direction of the connection.
+struct Link
+{
+	const char *name;
+	ENetAddress to{};
+	bool known = false; //The joiner's address is only known once it sends something.
+	Conditions conditions;
+	Stats interval, total;
+	std::priority_queue<Packet, std::vector<Packet>, std::greater<Packet>> queue;
+	Clock::time_point linkFree{}; //When the bandwidth cap lets the next packet out.
+	Clock::time_point lastDue{}; //Of the last packet that wasn't reordered. Keeps jitter from reordering.
+	uint64_t order = 0;
+
+	void Push(Clock::time_point now, const uint8_t *data, size_t size, std::mt19937 &rng)
+	{
+		std::uniform_real_distribution<double> percent(0, 100);
+		if(percent(rng) < conditions.loss)
+		{
+			interval.dropped++;
+			total.dropped++;
+			return;
+		}
+
+		auto departure = now;
+		if(conditions.bandwidth > 0)
+		{
+			departure = std::max(now, linkFree);
+			if(Ms(departure - now).count() > conditions.queue)
+			{
+				interval.queueDrops++;
+				total.queueDrops++;
+				return;
+			}
+			linkFree = departure + std::chrono::duration_cast<Clock::duration>(Ms(size*8/conditions.bandwidth));
+		}
+
+		double delay = conditions.latency;
+		if(conditions.jitter > 0)
+			delay += std::uniform_real_distribution<double>(0, conditions.jitter)(rng);
+		auto due = departure + std::chrono::duration_cast<Clock::duration>(Ms(delay));
+		if(percent(rng) < conditions.reorder)
+		{
+			due += std::chrono::duration_cast<Clock::duration>(Ms(conditions.reorderDelay));
+			interval.reordered++;
+			total.reordered++;
+		}
+		else
+			lastDue = due = std::max(due, lastDue);
+
+		queue.push({now, due, order++, std::vector<uint8_t>(data, data + size)});
+	}
+
+	void Deliver(Clock::time_point now, ENetSocket socket)
+	{
+		while(!queue.empty() && queue.top().due <= now)
+		{
+			auto &packet = queue.top();
+			if(known)
+			{
+				ENetBuffer buffer;
+				buffer.data = (void*)packet.data.data();
+				buffer.dataLength = packet.data.size();
+				enet_socket_send(socket, &to, &buffer, 1);
+				double delay = Ms(now - packet.arrival).count();
+				interval.Add(packet.data.size(), delay);
+				total.Add(packet.data.size(), delay);
+			}
+			queue.pop();
+		}
+	}
+};
+
+//A line of the schedule file looks like "<seconds> [host|joiner] key=value...".
+//Settings apply to the packets going to the host or the joiner, or both if neither is named.
+struct ScheduleEntry
+{
+	double time;
+	int target; //-1 for both links.
+	std::vector<std::pair<std::string, double>> values;
+};
+
+static bool ParseSchedule(const std::string &file, std::vector<ScheduleEntry> &schedule)
+{
+	std::ifstream in(file);
+	if(!in.is_open())
+	{
+		std::cerr << "Can't open schedule " << file << "\n";
+		return false;
+	}
+
+	std::string line;
+	for(int lineNumber = 1; std::getline(in, line); ++lineNumber)
+	{
+		line = line.substr(0, line.find('#'));
+		std::istringstream words(line);
+		ScheduleEntry entry{0, -1, {}};
+		if(!(words >> entry.time))
+		{
+			if(line.find_first_not_of(" \t\r") == std::string::npos)
+				continue;
+			std::cerr << file << ":" << lineNumber << ": Expected a time in seconds.\n";
+			return false;
+		}
+
+		Conditions check;
+		std::string word;
+		while(words >> word)
+		{
+			if(word == "host")
+				entry.target = 0;
+			else if(word == "joiner")
+				entry.target = 1;
+			else
+			{
+				auto equals = word.find('=');
+				std::string key = word.substr(0, equals);
+				double value = 0;
+				if(equals == std::string::npos || !(std::istringstream(word.substr(equals+1)) >> value) || !check.Set(key, value))
+				{
+					std::cerr << file << ":" << lineNumber << ": Can't make sense of " << word << "\n";
+					return false;
+				}
+				entry.values.push_back({key, value});
+			}
+		}
+		schedule.push_back(std::move(entry));
+	}
+	std::stable_sort(schedule.begin(), schedule.end(), [](const ScheduleEntry &a, const ScheduleEntry &b){
+		return a.time < b.time;
+	});
+	return true;
+}
+
+int main(int argc, char **argv)
+{
+	args::ArgumentParser parser("Network condition simulator.",
+	"Sits between two netplay instances as a UDP proxy and adds latency, jitter, loss, reordering and a bandwidth cap "
+	"to the packets going each way. Host at HOSTPORT as usual, then have the other instance join this proxy at PORT. "
+	"Spectators aren't proxied.");
+	args::Positional<int> listenPort(parser, "PORT", "Port the joining instance connects to.");
+	args::Positional<int> hostPort(parser, "HOSTPORT", "Port of the hosting instance.");
+	args::HelpFlag help(parser, "help", "Display this help menu.", {'h', "help"});
+	args::ValueFlag<std::string> hostAddress(parser, "address", "Address of the hosting instance. Defaults to 127.0.0.1.",
+		{'a', "address"}, "127.0.0.1");
+	args::ValueFlag<double> latency(parser, "ms", "One way latency.", {'l', "latency"}, 0);
+	args::ValueFlag<double> jitter(parser, "ms", "Random delay added on top of the latency.", {'j', "jitter"}, 0);
+	args::ValueFlag<double> loss(parser, "percent", "Packet loss.", {"loss"}, 0);
+	args::ValueFlag<double> reorder(parser, "percent", "Packets held back so later ones overtake them.", {"reorder"}, 0);
+	args::ValueFlag<double> reorderDelay(parser, "ms", "How long reordered packets are held back. Defaults to 20.", {"reorder-delay"}, 20);
+	args::ValueFlag<double> bandwidth(parser, "kbps", "Bandwidth cap each way. 0, the default, is unlimited.", {'b', "bandwidth"}, 0);
+	args::ValueFlag<double> queue(parser, "ms",
+		"Packets queued behind the bandwidth cap for longer than this are dropped. Defaults to 200.", {"queue"}, 200);
+	args::ValueFlag<std::string> schedule(parser, "file",
+		"Changes the conditions over time. Each line is \"<seconds> [host|joiner] key=value...\", "
+		"with the keys latency, jitter, loss, reorder, reorderDelay, bandwidth and queue. "
+		"host and joiner limit the line to the packets going to that side.", {'s', "schedule"});
+	args::ValueFlag<uint32_t> seed(parser, "seed", "Random seed, so runs can be repeated. Defaults to 1.", {"seed"}, 1);
+	args::ValueFlag<std::string> log(parser, "file", "Writes the statistics of each link as CSV. Defaults to netsim.csv.",
+		{'o'}, "netsim.csv");
+	args::ValueFlag<double> logInterval(parser, "seconds", "How often statistics are logged. Defaults to 1.", {"interval"}, 1);
+	args::ValueFlag<double> duration(parser, "seconds", "Quits after this long. Runs until interrupted otherwise.", {"duration"});
+	try
+	{
+		parser.ParseCLI(argc, argv);
+		if(!listenPort || !hostPort)
+		{
+			std::cout << "Both ports are needed. Use -h for help.";
+			return 0;
+		}
+	}
+	catch (const args::Help&)
+	{
+		std::cout << parser;
+		return 0;
+	}
+	catch (const args::ParseError& e)
+	{
+		std::cerr << e.what() << std::endl;
+		std::cerr << parser;
+		return 1;
+	}
+
+	std::vector<ScheduleEntry> entries;
+	if(schedule && !ParseSchedule(args::get(schedule), entries))
+		return 1;
+
+	std::ofstream csv(args::get(log));
+	if(!csv.is_open())
+	{
+		std::cerr << "Can't write statistics to " << args::get(log) << "\n";
+		return 1;
+	}
+	csv << "seconds,link,latency,jitter,loss,reorder,bandwidth,packets,kbps,dropped,queue drops,reordered,avg delay ms,max delay ms\n";
+
+	if(enet_initialize() != 0)
+	{
+		std::cerr << "An error occurred while initializing ENet.\n";
+		return 1;
+	}
+
+	Link links[2];
+	links[0].name = "host";
+	links[1].name = "joiner";
+	for(auto &link : links)
+	{
+		auto &c = link.conditions;
+		c.latency = args::get(latency);
+		c.jitter = args::get(jitter);
+		c.loss = args::get(loss);
+		c.reorder = args::get(reorder);
+		c.reorderDelay = args::get(reorderDelay);
+		c.bandwidth = args::get(bandwidth);
+		c.queue = args::get(queue);
+	}
+	Link &toHost = links[0];
+	Link &toJoiner = links[1];
+
+	if(enet_address_set_host(&toHost.to, args::get(hostAddress).c_str()) < 0)
+	{
+		std::cerr << "Can't resolve " << args::get(hostAddress) << "\n";
+		enet_deinitialize();
+		return 1;
+	}
+	toHost.to.port = args::get(hostPort);
+	toHost.known = true;
+
+	ENetAddress listenAddress;
+	listenAddress.host = ENET_HOST_ANY;
+	listenAddress.port = args::get(listenPort);
+	ENetSocket socket = enet_socket_create(ENET_SOCKET_TYPE_DATAGRAM);
+	if(socket == ENET_SOCKET_NULL || enet_socket_bind(socket, &listenAddress) < 0)
+	{
+		std::cerr << "Can't listen at port " << listenAddress.port << "\n";
+		if(socket != ENET_SOCKET_NULL)
+			enet_socket_destroy(socket);
+		enet_deinitialize();
+		return 1;
+	}
+	enet_socket_set_option(socket, ENET_SOCKOPT_NONBLOCK, 1);
+	std::signal(SIGINT, [](int){ quit = 1; });
+	std::cout << "Forwarding port " << listenAddress.port << " to " << args::get(hostAddress) << ":" << toHost.to.port << "\n";
+
+	std::mt19937 rng(args::get(seed));
+	auto start = Clock::now();
+	auto nextLog = start;
+	size_t nextEntry = 0;
+	uint8_t data[maxPacketSize];
+
+	auto writeStats = [&](double seconds)
+	{
+		double elapsed = std::max(args::get(logInterval), 0.001);
+		for(auto &link : links)
+		{
+			auto &s = link.interval;
+			auto &c = link.conditions;
+			csv << seconds << "," << link.name << "," << c.latency << "," << c.jitter << "," << c.loss << "," << c.reorder << ","
+				<< c.bandwidth << "," << s.packets << "," << s.bytes*8/1000.0/elapsed << "," << s.dropped << "," << s.queueDrops << ","
+				<< s.reordered << "," << (s.packets ? s.delaySum/s.packets : 0) << "," << s.delayMax << "\n";
+			s = {};
+		}
+		csv.flush();
+	};
+
+	while(!quit)
+	{
+		auto now = Clock::now();
+		double seconds = std::chrono::duration<double>(now - start).count();
+		if(duration && seconds >= args::get(duration))
+			break;
+
+		for(; nextEntry < entries.size() && entries[nextEntry].time <= seconds; ++nextEntry)
+		{
+			auto &entry = entries[nextEntry];
+			for(int i = 0; i < 2; ++i)
+			{
+				if(entry.target >= 0 && entry.target != i)
+					continue;
+				for(auto &[key, value] : entry.values)
+					links[i].conditions.Set(key, value);
+			}
+			std::cout << seconds << "s: Schedule line " << nextEntry + 1 << " applied.\n";
+		}
+
+		toHost.Deliver(now, socket);
+		toJoiner.Deliver(now, socket);
+
+		if(now >= nextLog)
+		{
+			if(now > start)
+				writeStats(seconds);
+			nextLog += std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(args::get(logInterval)));
+		}
+
+		//Packets are timed to the millisecond, which is plenty next to a 16 ms frame.
+		enet_uint32 condition = ENET_SOCKET_WAIT_RECEIVE;
+		if(enet_socket_wait(socket, &condition, 1) < 0 || !(condition & ENET_SOCKET_WAIT_RECEIVE))
+			continue;
+
+		ENetAddress from;
+		ENetBuffer buffer;
+		buffer.data = data;
+		buffer.dataLength = sizeof(data);
+		int size;
+		while((size = enet_socket_receive(socket, &from, &buffer, 1)) > 0)
+		{
+			now = Clock::now();
+			if(from.host == toHost.to.host && from.port == toHost.to.port)
+				toJoiner.Push(now, data, size, rng);
+			else
+			{
+				if(!toJoiner.known || from.host != toJoiner.to.host || from.port != toJoiner.to.port)
+				{
+					std::cout << "Joiner at " << from.host << ":" << from.port << "\n";
+					toJoiner.to = from;
+					toJoiner.known = true;
+				}
+				toHost.Push(now, data, size, rng);
+			}
+		}
+	}
+
+	std::cout << "\nTotals:\n";
+	for(auto &link : links)
+	{
+		auto &s = link.total;
+		std::cout << "To " << link.name << ": " << s.packets << " packets, " << s.bytes << " bytes, " << s.dropped << " lost, "
+			<< s.queueDrops << " dropped by the bandwidth cap, " << s.reordered << " reordered, "
+			<< (s.packets ? s.delaySum/s.packets : 0) << " ms average delay, " << s.delayMax << " ms max.\n";
+	}
+
+	enet_socket_destroy(socket);
+	enet_deinitialize();
+	return 0;
+}
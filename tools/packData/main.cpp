@@ -0,0 +1,178 @@
+#include <args.hxx>
+#include <archive.h>
+#include <lz4.h>
+#include <lz4hc.h>
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+//Small entries are only aligned enough to read their headers and vertex data in place.
+//Big uncompressed ones start on a page so touching them doesn't pull in their neighbours.
+constexpr uint32_t minAlignment = 16;
+constexpr uint32_t pageAlignment = 4096;
+constexpr size_t pageAlignThreshold = 64*1024;
+
+struct PackEntry
+{
+	std::string name;
+	fs::path path;
+	archive::Entry entry{};
+	std::vector<char> stored;
+};
+
+static uint64_t Align(uint64_t value, uint64_t alignment)
+{
+	return (value + alignment - 1)/alignment*alignment;
+}
+
+static bool ReadFile(const fs::path &path, std::vector<char> &out)
+{
+	std::ifstream file(path, std::ios::binary | std::ios::ate);
+	if(!file.is_open())
+		return false;
+	out.resize(file.tellg());
+	file.seekg(0);
+	file.read(out.data(), out.size());
+	return !file.fail();
+}
+
+int main(int argc, char **argv)
+{
+	args::ArgumentParser parser("Data archive packer.",
+	"Packs every file in a folder into a single archive the game maps at startup. "
+	"Names are stored relative to the folder's parent, so packing \"data\" gives names like data/char/vaki/def.lua.");
+	args::Positional<std::string> folder(parser, "FOLDER", "Folder to pack.");
+	args::HelpFlag help(parser, "help", "Display this help menu.", {'h', "help"});
+	args::ValueFlag<std::string> outName(parser, "name", "Output filename. Defaults to data.afa.", {'o'}, "data.afa");
+	args::Flag store(parser, "store", "Store every file as is, without LZ4.", {'s', "store"});
+	args::ValueFlag<int> ratio(parser, "percent",
+		"Keep the LZ4 data only if it's at most this percentage of the original size. Defaults to 90. "
+		"Data that's already compressed like lzs3 or ogg ends up stored as is.",
+		{'r', "ratio"}, 90);
+	try
+	{
+		parser.ParseCLI(argc, argv);
+		if(!folder)
+		{
+			std::cout << "No folder selected. Use -h for help.";
+			return 0;
+		}
+	}
+	catch (const args::Help&)
+	{
+		std::cout << parser;
+		return 0;
+	}
+	catch (const args::ParseError& e)
+	{
+		std::cerr << e.what() << std::endl;
+		std::cerr << parser;
+		return 1;
+	}
+
+	fs::path input = fs::absolute(args::get(folder)).lexically_normal();
+	if(!input.has_filename()) //Trailing separator.
+		input = input.parent_path();
+	if(!fs::is_directory(input))
+	{
+		std::cerr << input << " is not a folder.\n";
+		return 1;
+	}
+	fs::path base = input.parent_path();
+	fs::path output = fs::absolute(args::get(outName)).lexically_normal();
+
+	std::vector<PackEntry> entries;
+	for(auto &file : fs::recursive_directory_iterator(input))
+	{
+		if(!file.is_regular_file() || file.path() == output)
+			continue;
+		entries.push_back({file.path().lexically_relative(base).generic_string(), file.path()});
+	}
+	//Lookups binary search the table, so it has to be sorted the same way vfs compares names.
+	std::sort(entries.begin(), entries.end(), [](const PackEntry &a, const PackEntry &b){
+		return a.name < b.name;
+	});
+
+	std::string names;
+	uint64_t totalSize = 0;
+	for(auto &pack : entries)
+	{
+		std::vector<char> data;
+		if(!ReadFile(pack.path, data))
+		{
+			std::cerr << "Can't read " << pack.path << "\n";
+			return 1;
+		}
+
+		auto &entry = pack.entry;
+		entry.nameOffset = names.size();
+		entry.nameSize = pack.name.size();
+		names += pack.name;
+		entry.size = data.size();
+		totalSize += data.size();
+
+		if(!store && !data.empty() && data.size() <= LZ4_MAX_INPUT_SIZE)
+		{
+			std::vector<char> compressed(LZ4_compressBound(data.size()));
+			int size = LZ4_compress_HC(data.data(), compressed.data(), data.size(), compressed.size(), LZ4HC_CLEVEL_DEFAULT);
+			if(size > 0 && (uint64_t)size*100 <= data.size()*(uint64_t)args::get(ratio))
+			{
+				compressed.resize(size);
+				entry.flags |= archive::lz4;
+				data = std::move(compressed);
+			}
+		}
+
+		entry.storedSize = data.size();
+		bool mapped = !(entry.flags & archive::lz4) && data.size() >= pageAlignThreshold;
+		entry.alignment = mapped ? pageAlignment : minAlignment;
+		pack.stored = std::move(data);
+	}
+
+	archive::Header header{
+		.magic = archive::magic,
+		.version = archive::version,
+		.entryCount = (uint32_t)entries.size(),
+		.namesSize = (uint32_t)names.size(),
+	};
+
+	uint64_t offset = sizeof(header) + sizeof(archive::Entry)*entries.size() + names.size();
+	for(auto &pack : entries)
+	{
+		offset = Align(offset, pack.entry.alignment);
+		pack.entry.offset = offset;
+		offset += pack.entry.storedSize;
+	}
+
+	std::ofstream out(output, std::ios::binary);
+	if(!out.is_open())
+	{
+		std::cerr << "Can't open " << output << " for writing.\n";
+		return 1;
+	}
+	out.write((char*)&header, sizeof(header));
+	for(auto &pack : entries)
+		out.write((char*)&pack.entry, sizeof(pack.entry));
+	out.write(names.data(), names.size());
+
+	const char padding[pageAlignment] = {};
+	for(auto &pack : entries)
+	{
+		out.write(padding, pack.entry.offset - out.tellp());
+		out.write(pack.stored.data(), pack.stored.size());
+	}
+	out.close();
+	if(out.fail())
+	{
+		std::cerr << "Error while writing " << output << "\n";
+		return 1;
+	}
+
+	std::cout << "Packed " << entries.size() << " files, " << totalSize << " bytes into " << offset << ".\n";
+	return 0;
+}